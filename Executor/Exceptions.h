@@ -65,6 +65,18 @@ public:
     illegal_assumption(const llvm::Value* v): std::runtime_error{util::toString(*v)}, value_{v}{};
 };
 
+class step_limit_exceeded : public std::runtime_error {
+public:
+    step_limit_exceeded(size_t limit):
+        std::runtime_error(tfm::format("Executor step limit exceeded: %d", limit)) {};
+};
+
+class time_limit_exceeded : public std::runtime_error {
+public:
+    time_limit_exceeded(size_t limit):
+        std::runtime_error(tfm::format("Executor time limit exceeded: %ds", limit)) {};
+};
+
 class unreachable_reached : public std::runtime_error {
 public:
     unreachable_reached(): std::runtime_error{ "unreachable reached" }{};
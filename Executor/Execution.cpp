@@ -31,6 +31,7 @@
 #include <llvm/ExecutionEngine/GenericValue.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 
 #include "Executor/ExecutionEngine.h"
@@ -136,7 +137,7 @@ void borealis::ExecutionEngine::LoadValueFromMemory(llvm::GenericValue &Result,
 //===----------------------------------------------------------------------===//
 
 static void SetValue(Value *V, GenericValue Val, ExecutorContext &SF) {
-    SF.Values[V] = Val;
+    SF.setValue(V, std::move(Val));
 }
 
 //===----------------------------------------------------------------------===//
@@ -1078,6 +1079,8 @@ void borealis::ExecutionEngine::SwitchToNewBasicBlock(BasicBlock *Dest, Executor
     BasicBlock *PrevBB = SF.CurBB;      // Remember where we came from...
     SF.CurBB   = Dest;                  // Update CurBB to branch destination
     SF.CurInst = SF.CurBB->begin();     // Update new instruction ptr...
+    auto Start = SF.Decoded->getBlockStart(Dest);
+    SF.jumpTo(Start);
 
     if (!isa<PHINode>(SF.CurInst)) return;  // Nothing fancy to do
 
@@ -1085,6 +1088,7 @@ void borealis::ExecutionEngine::SwitchToNewBasicBlock(BasicBlock *Dest, Executor
     std::vector<GenericValue> ResultValues;
 
     for (; PHINode *PN = dyn_cast<PHINode>(SF.CurInst); ++SF.CurInst) {
+        SF.step();
         // Search for the value corresponding to this previous bb...
         int i = PN->getBasicBlockIndex(PrevBB);
         ASSERTC(i != -1 && "PHINode doesn't contain entry for predecessor??");
@@ -1096,10 +1100,13 @@ void borealis::ExecutionEngine::SwitchToNewBasicBlock(BasicBlock *Dest, Executor
 
     // Now loop over all of the PHI nodes setting their values...
     SF.CurInst = SF.CurBB->begin();
+    SF.jumpTo(Start);
     for (unsigned i = 0; isa<PHINode>(SF.CurInst); ++SF.CurInst, ++i) {
+        SF.step();
         PHINode *PN = cast<PHINode>(SF.CurInst);
         SetValue(PN, ResultValues[i], SF);
     }
+    SF.Current = nullptr;
 }
 
 //===----------------------------------------------------------------------===//
@@ -2282,8 +2289,8 @@ GenericValue borealis::ExecutionEngine::getOperandValue(Value *V, ExecutorContex
         return GenericValue{
             Mem.getPointerToGlobal(GV, TD->getTypeSizeInBits(GV->getType()->getPointerElementType()), 0)
         };
-    } else if(auto gv = util::at(SF.Values, V)) {
-        for(auto&& val : gv) return val;
+    } else if(auto gv = SF.getValue(V)) {
+        return *gv;
     } else if(!V->getType()->isPointerTy()) {
         return Judicator->map(V);
     } else {
@@ -2310,6 +2317,7 @@ void borealis::ExecutionEngine::callFunction(Function *F,
     ECStack.push_back(ExecutorContext());
     ExecutorContext &StackFrame = ECStack.back();
     StackFrame.CurFunction = F;
+    StackFrame.setDecoded(getDecodedFunction(F));
 
     // Special handling for external functions.
     if (F->isDeclaration()) {
@@ -2323,6 +2331,7 @@ void borealis::ExecutionEngine::callFunction(Function *F,
     // Get pointers to first LLVM BB & Instruction in function.
     StackFrame.CurBB     = F->begin();
     StackFrame.CurInst   = StackFrame.CurBB->begin();
+    StackFrame.jumpTo(0);
 
     // Run through the function arguments and initialize their values...
     ASSERT((ArgVals.size() == F->arg_size() ||
@@ -2342,12 +2351,21 @@ void borealis::ExecutionEngine::callFunction(Function *F,
 
 void borealis::ExecutionEngine::run() {
     TRACE_FUNC;
+    size_t steps = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(TimeLimit);
     while (!ECStack.empty()) {
         // Interpret a single instruction & increment the "PC".
         ExecutorContext &SF = ECStack.back();  // Current stack frame
         Instruction &I = *SF.CurInst++;         // Increment before execute
+        SF.step();
 
         // Track the number of dynamic instructions executed.
+        ++steps;
+        if (StepLimit && steps > StepLimit) throw step_limit_exceeded(StepLimit);
+        // the clock is not cheap enough to be read on every instruction
+        if (TimeLimit && (steps & 0xFFF) == 0 && std::chrono::steady_clock::now() > deadline) {
+            throw time_limit_exceeded(TimeLimit);
+        }
 
         IE.visit(I);   // Dispatch to one of the visit* methods...
     }
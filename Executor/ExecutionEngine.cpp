@@ -30,7 +30,7 @@ ExecutionEngine::ExecutionEngine(
     VariableInfoTracker* VIT,
     Arbiter::Ptr Aldaris):
         ExitValue{}, TD{TD}, TLI{TLI}, ST{ST}, VIT{VIT}, IM{}, Judicator{ Aldaris },
-        ECStack{}, AtExitHandlers{}, Mem{ *TD }, FNCache{}, IE{this}
+        ECStack{}, AtExitHandlers{}, Mem{ *TD }, FNCache{}, IE{this}, StepLimit{0}, TimeLimit{0}
 {
     IM = &IntrinsicsManager::getInstance();
     FNCache = [ST](auto f){ return FactoryNest(f->getDataLayout(), ST->getSlotTracker(f)); };
@@ -39,6 +39,33 @@ ExecutionEngine::ExecutionEngine(
 ExecutionEngine::~ExecutionEngine()
 {}
 
+DecodedFunction::DecodedFunction(const llvm::Function* F) : NumSlots{0} {
+    for (auto&& arg : F->getArgumentList()) Slots[&arg] = NumSlots++;
+    for (auto&& BB : *F) {
+        for (auto&& inst : BB) {
+            if (!inst.getType()->isVoidTy()) Slots[&inst] = NumSlots++;
+        }
+    }
+
+    for (auto&& BB : *F) {
+        Blocks[&BB] = Instructions.size();
+        for (auto&& inst : BB) {
+            DecodedInstruction decoded{ &inst, getSlot(&inst), {} };
+            for (auto&& op : inst.operands()) {
+                auto slot = getSlot(op.get());
+                if (slot != NoSlot) decoded.Operands.emplace_back(op.get(), slot);
+            }
+            Instructions.push_back(std::move(decoded));
+        }
+    }
+}
+
+const DecodedFunction* ExecutionEngine::getDecodedFunction(const llvm::Function* F) {
+    auto&& decoded = DecodedFunctions[F];
+    if (!decoded) decoded = util::uniq(new DecodedFunction(F));
+    return decoded.get();
+}
+
 
 void ExecutionEngine::runAtExitHandlers () {
     while (!AtExitHandlers.empty()) {
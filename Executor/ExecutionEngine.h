@@ -9,6 +9,7 @@
 #define EXECUTOR_EXECUTIONENGINE_H_
 
 #include <unordered_map>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/GenericValue.h>
 #include <llvm/IR/CallSite.h>
@@ -31,37 +32,119 @@
 
 #include "Util/cache.hpp"
 
+#include "Util/macros.h"
+
 namespace borealis {
 
 struct AllocaHolder{};
 
+// Slots of an instruction and its local operands, so that executing it needs no lookups
+struct DecodedInstruction {
+    const llvm::Instruction* Inst;
+    unsigned Result; // NoSlot for instructions without a value
+    std::vector<std::pair<const llvm::Value*, unsigned>> Operands; // arguments and instructions only
+};
+
+// Dense numbering of function arguments and value-producing instructions,
+// computed once per function and shared by all its invocations
+struct DecodedFunction {
+    static constexpr unsigned NoSlot = ~0U;
+
+    llvm::DenseMap<const llvm::Value*, unsigned> Slots;
+    unsigned NumSlots;
+    std::vector<DecodedInstruction> Instructions; // in the order of the function body
+    llvm::DenseMap<const llvm::BasicBlock*, unsigned> Blocks; // index of the first instruction of a block
+
+    explicit DecodedFunction(const llvm::Function* F);
+
+    unsigned getSlot(const llvm::Value* V) const {
+        auto it = Slots.find(V);
+        return it == Slots.end() ? NoSlot : it->second;
+    }
+
+    unsigned getBlockStart(const llvm::BasicBlock* BB) const {
+        auto it = Blocks.find(BB);
+        ASSERTC(it != Blocks.end());
+        return it->second;
+    }
+};
+
 struct ExecutorContext {
     llvm::Function             *CurFunction;// The currently executing llvm::Function
     llvm::BasicBlock           *CurBB;      // The currently executing BB
     llvm::BasicBlock::iterator  CurInst;    // The next instruction to execute
     llvm::CallSite              Caller;     // Holds the call that called subframes.
     // NULL if main func or debugger invoked fn
-    std::unordered_map<llvm::Value*, llvm::GenericValue> Values; // LLVM values used in this invocation
+    const DecodedFunction      *Decoded;    // Slot numbering of CurFunction
+    unsigned                    CurIndex;   // Index of CurInst in Decoded
+    const DecodedInstruction   *Current;    // The instruction being executed
+    std::vector<llvm::GenericValue> Registers; // LLVM values used in this invocation, indexed by slot
+    std::vector<bool> Defined;       // Registers that have been assigned
     std::vector<llvm::GenericValue> VarArgs; // Values passed through an ellipsis
     AllocaHolder Allocas;            // Track memory allocated by alloca
 
-    ExecutorContext() : CurFunction(nullptr), CurBB(nullptr), CurInst(nullptr) {}
+    ExecutorContext() : CurFunction(nullptr), CurBB(nullptr), CurInst(nullptr), Decoded(nullptr), CurIndex(0), Current(nullptr) {}
 
     ExecutorContext(ExecutorContext &&O)
     : CurFunction(O.CurFunction), CurBB(O.CurBB), CurInst(O.CurInst),
-      Caller(O.Caller), Values(std::move(O.Values)),
-      VarArgs(std::move(O.VarArgs)), Allocas(std::move(O.Allocas)) {}
+      Caller(O.Caller), Decoded(O.Decoded), CurIndex(O.CurIndex), Current(O.Current), Registers(std::move(O.Registers)),
+      Defined(std::move(O.Defined)), VarArgs(std::move(O.VarArgs)), Allocas(std::move(O.Allocas)) {}
 
     ExecutorContext &operator=(ExecutorContext &&O) {
         CurFunction = O.CurFunction;
         CurBB = O.CurBB;
         CurInst = O.CurInst;
         Caller = O.Caller;
-        Values = std::move(O.Values);
+        Decoded = O.Decoded;
+        CurIndex = O.CurIndex;
+        Current = O.Current;
+        Registers = std::move(O.Registers);
+        Defined = std::move(O.Defined);
         VarArgs = std::move(O.VarArgs);
         Allocas = std::move(O.Allocas);
         return *this;
     }
+
+    void setDecoded(const DecodedFunction* D) {
+        Decoded = D;
+        Registers.resize(D->NumSlots);
+        Defined.assign(D->NumSlots, false);
+    }
+
+    // Moves to the instruction @CurInst points to, it is the @Index'th one of the function
+    void jumpTo(unsigned Index) {
+        CurIndex = Index;
+        Current = nullptr;
+    }
+
+    // Called for every instruction executed, right after @CurInst is advanced
+    void step() {
+        Current = &Decoded->Instructions[CurIndex++];
+    }
+
+    // Returns nullptr if @V is not a local value or was not assigned yet
+    const llvm::GenericValue* getValue(const llvm::Value* V) const {
+        if (!Decoded) return nullptr;
+        auto slot = DecodedFunction::NoSlot;
+        if (Current) {
+            for (auto&& op : Current->Operands) {
+                if (op.first == V) {
+                    slot = op.second;
+                    break;
+                }
+            }
+        }
+        if (slot == DecodedFunction::NoSlot) slot = Decoded->getSlot(V);
+        if (slot == DecodedFunction::NoSlot || !Defined[slot]) return nullptr;
+        return &Registers[slot];
+    }
+
+    void setValue(const llvm::Value* V, llvm::GenericValue Val) {
+        auto slot = (Current && Current->Inst == V) ? Current->Result : Decoded->getSlot(V);
+        ASSERTC(slot != DecodedFunction::NoSlot);
+        Registers[slot] = std::move(Val);
+        Defined[slot] = true;
+    }
 };
 
 
@@ -85,9 +168,15 @@ class ExecutionEngine {
     MemorySimulator Mem;
 
     util::cache<llvm::Function*, FactoryNest> FNCache;
+    std::unordered_map<const llvm::Function*, std::unique_ptr<DecodedFunction>> DecodedFunctions;
 
     InstructionExecutor IE;
 
+    // Maximum number of instructions run() may execute, 0 means unlimited
+    size_t StepLimit;
+    // Maximum number of seconds run() may take, 0 means unlimited
+    size_t TimeLimit;
+
 public:
     explicit ExecutionEngine(
         llvm::Module *M,
@@ -110,6 +199,9 @@ public:
         return Mem.getOpaquePtr();
     }
 
+    void setStepLimit(size_t limit) { StepLimit = limit; }
+    void setTimeLimit(size_t limit) { TimeLimit = limit; }
+
     /// runAtExitHandlers - Run any functions registered by the program's calls to
     /// atexit(3), which we intercept and store in AtExitHandlers.
     ///
@@ -162,6 +254,7 @@ public:
     void initializeExternalFunctions();
     llvm::GenericValue getConstantExprValue(llvm::ConstantExpr *CE, ExecutorContext &SF);
     llvm::GenericValue getOperandValue(llvm::Value *V, ExecutorContext &SF);
+    const DecodedFunction* getDecodedFunction(const llvm::Function* F);
     llvm::GenericValue executeTruncInst(llvm::Value *SrcVal, llvm::Type *DstTy,
         ExecutorContext &SF);
     llvm::GenericValue executeSExtInst(llvm::Value *SrcVal, llvm::Type *DstTy,
@@ -248,4 +341,6 @@ public:
 
 } /* namespace borealis */
 
+#include "Util/unmacros.h"
+
 #endif /* EXECUTOR_EXECUTIONENGINE_H_ */
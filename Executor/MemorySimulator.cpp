@@ -22,6 +22,7 @@
 #include "Util/collections.hpp"
 #include "Config/config.h"
 
+#include "Executor/MemorySimulator/PagedMemoryImpl.h"
 #include "Executor/MemorySimulator/SegmentTreeImpl.h"
 #include "Executor/MemorySimulator/GlobalMemory.h"
 
@@ -31,6 +32,9 @@
 
 namespace borealis {
 
+static config::StringConfigEntry MemoryBackendKind{"executor", "memory-backend"};
+static config::ConfigEntry<int> PageSize{"executor", "memory-page-size"};
+
 template<class T>
 static llvm::ArrayRef<uint8_t> bufferOfPod(const T& value, size_t bytes) {
     TRACE_FUNC;
@@ -55,7 +59,7 @@ struct hex {
 
 
 struct MemorySimulator::Impl {
-    SegmentTree tree;
+    std::unique_ptr<MemoryBackend> memory;
     std::unordered_map<llvm::Value*, SimulatedPtr> constants;
     std::map<SimulatedPtr, llvm::Value*> constantsBwd;
 
@@ -83,15 +87,25 @@ struct MemorySimulator::Impl {
         auto grain = dl.getPointerPrefAlignment(0);
         if(!grain) grain = dl.getPointerSize(0);
         if(!grain) grain = 1;
-        tree.chunk_size = K.get(1) * grain;
-        tree.start = SimulatedPtr(1 << 20);
-        tree.end = tree.start + (1ULL << M.get(33ULL)) * tree.chunk_size;
+        SimulatedPtrSize chunk_size = K.get(1) * grain;
+        auto start = SimulatedPtr(1 << 20);
+        auto end = start + (1ULL << M.get(33ULL)) * chunk_size;
+
+        if (MemoryBackendKind.get("segment-tree") == "paged") {
+            memory = util::uniq(new PagedMemory{ start, end, chunk_size, SimulatedPtrSize(PageSize.get(4096)) });
+        } else {
+            auto tree = util::uniq(new SegmentTree{});
+            tree->start = start;
+            tree->end = end;
+            tree->chunk_size = chunk_size;
+            memory = std::move(tree);
+        }
 
-        allocStart = tree.start;
-        allocEnd = tree.start + (tree.end - tree.start) / 2;
+        allocStart = start;
+        allocEnd = start + (end - start) / 2;
 
         mallocStart = allocEnd;
-        mallocEnd = tree.end;
+        mallocEnd = end;
 
         constantStart = SimulatedPtr(1 << 10);
         constantEnd = SimulatedPtr(1 << 20);
@@ -172,7 +186,7 @@ struct MemorySimulator::Impl {
 };
 
 uintptr_t MemorySimulator::getQuant() const {
-    return pimpl_->tree.chunk_size;
+    return pimpl_->memory->chunk_size;
 }
 
 void* MemorySimulator::getOpaquePtr() {
@@ -775,7 +789,7 @@ static SimulatedPtrSize calc_real_memory_amount(SimulatedPtrSize amount, Simulat
 
 void* MemorySimulator::AllocateMemory(SimulatedPtrSize amount) {
     TRACE_FUNC;
-    const auto real_amount = calc_real_memory_amount(amount, pimpl_->tree.chunk_size);
+    const auto real_amount = calc_real_memory_amount(amount, pimpl_->memory->chunk_size);
 
     SimulatedPtr ptr;
     if(pimpl_->currentAllocOffset % real_amount == 0) {
@@ -784,7 +798,7 @@ void* MemorySimulator::AllocateMemory(SimulatedPtrSize amount) {
         ptr = pimpl_->allocStart + (pimpl_->currentAllocOffset / real_amount + 1) * real_amount;
     }
 
-    pimpl_->tree.allocate(ptr, amount, SegmentNode::MemoryState::Uninit, SegmentNode::MemoryStatus::Alloca);
+    pimpl_->memory->allocate(ptr, amount, SegmentNode::MemoryState::Uninit, SegmentNode::MemoryStatus::Alloca);
 
     pimpl_->currentAllocOffset = ptr + real_amount - pimpl_->allocStart;
 
@@ -797,12 +811,12 @@ void MemorySimulator::DeallocateMemory(void* ptr) {
     auto realPtr = ptr_cast(ptr);
     if(!pimpl_->isAPointer(realPtr)) signalIllegalFree(realPtr);
 
-    pimpl_->tree.free(realPtr, SegmentNode::MemoryStatus::Alloca);
+    pimpl_->memory->free(realPtr, SegmentNode::MemoryStatus::Alloca);
 }
 
 void* MemorySimulator::MallocMemory(SimulatedPtrSize amount, MallocFill fillWith) {
     TRACE_FUNC;
-    const auto real_amount = calc_real_memory_amount(amount, pimpl_->tree.chunk_size);
+    const auto real_amount = calc_real_memory_amount(amount, pimpl_->memory->chunk_size);
     const auto memState = (fillWith == MallocFill::ZERO) ? SegmentNode::MemoryState::Memset : SegmentNode::MemoryState::Uninit;
 
     SimulatedPtr ptr;
@@ -812,7 +826,7 @@ void* MemorySimulator::MallocMemory(SimulatedPtrSize amount, MallocFill fillWith
         ptr = pimpl_->mallocStart + (pimpl_->currentMallocOffset / real_amount + 1) * real_amount;
     }
 
-    pimpl_->tree.allocate(ptr, amount, memState, SegmentNode::MemoryStatus::Malloc);
+    pimpl_->memory->allocate(ptr, amount, memState, SegmentNode::MemoryStatus::Malloc);
     pimpl_->currentMallocOffset = ptr + real_amount - pimpl_->mallocStart;
 
     return ptr_cast(ptr);
@@ -824,7 +838,7 @@ void MemorySimulator::FreeMemory(void* ptr) {
     auto realPtr = ptr_cast(ptr);
     if(!pimpl_->isAPointer(realPtr)) signalIllegalFree(realPtr);
 
-    pimpl_->tree.free(realPtr, SegmentNode::MemoryStatus::Malloc);
+    pimpl_->memory->free(realPtr, SegmentNode::MemoryStatus::Malloc);
 }
 
 static void assign(MemorySimulator::mutable_buffer_t dst, MemorySimulator::buffer_t src) {
@@ -838,7 +852,7 @@ auto MemorySimulator::LoadBytesFromMemory(mutable_buffer_t buffer, buffer_t wher
     ASSERTC(buffer.size() == where.size());
 
     const auto size = where.size();
-    const auto chunk_size = pimpl_->tree.chunk_size;
+    const auto chunk_size = pimpl_->memory->chunk_size;
     auto ptr = ptr_cast(where.data());
     TRACE_PARAM(ptr);
     if(!pimpl_->isAPointer(ptr)) signalIllegalLoad(ptr);
@@ -855,13 +869,11 @@ auto MemorySimulator::LoadBytesFromMemory(mutable_buffer_t buffer, buffer_t wher
         return ValueState::CONCRETE;
     }
 
-    auto offset = ptr - pimpl_->tree.start;
+    auto offset = ptr - pimpl_->memory->start;
     auto loaded = (SimulatedPtrSize)0;
 
 
     while(loaded < size) {
-        const auto current = pimpl_->tree.get(ptr);
-
         auto current_size = chunk_size;
         // if we start in the middle of a chunk
         current_size -= offset % chunk_size;
@@ -871,6 +883,8 @@ auto MemorySimulator::LoadBytesFromMemory(mutable_buffer_t buffer, buffer_t wher
             current_size -= (chunk_size - leftover);
         }
 
+        const auto current = pimpl_->memory->get(ptr, current_size);
+
         auto slice = buffer.slice(loaded, current_size);
         if(current.memState == SegmentNode::MemoryState::Memset) {
             std::memset(slice.data(), current.filledWith, slice.size());
@@ -910,7 +924,7 @@ void MemorySimulator::StoreBytesToMemory(buffer_t buffer, mutable_buffer_t where
         return;
     }
 
-    pimpl_->tree.store(realPtr, Src, size);
+    pimpl_->memory->store(realPtr, Src, size);
     // XXX: what about endianness?
 }
 
@@ -937,7 +951,7 @@ auto MemorySimulator::LoadIntFromMemory(llvm::APInt& val, buffer_t where) -> Val
     const auto realPtr = ptr_cast(Ptr);
     if(!pimpl_->isAPointer(realPtr)) signalIllegalLoad(realPtr);
 
-    const auto chunk_size = pimpl_->tree.chunk_size;
+    const auto chunk_size = pimpl_->memory->chunk_size;
     auto chunk_index = LAM(ptr, uintptr_t(ptr) / chunk_size);
 
     ASSERTC(size <= chunk_size);
@@ -959,7 +973,7 @@ auto MemorySimulator::LoadIntFromMemory(llvm::APInt& val, buffer_t where) -> Val
         return ValueState::CONCRETE;
     }
 
-    auto&& load = pimpl_->tree.get(realPtr);
+    auto&& load = pimpl_->memory->get(realPtr, size);
 
     uint8_t* Src = load.data;
 
@@ -1007,7 +1021,7 @@ void* MemorySimulator::MemChr(void* ptr, uint8_t ch, size_t limit) {
         return ptr_cast(realPtr + ptrSub(ret, ptr));
     }
 
-    auto ret = pimpl_->tree.memchr(ptr_cast(ptr), ch, limit);
+    auto ret = pimpl_->memory->memchr(ptr_cast(ptr), ch, limit);
     return ptr_cast(ret);
 }
 
@@ -1015,7 +1029,7 @@ void MemorySimulator::Memset(void* dst, uint8_t fill, size_t size) {
     auto realPtr = ptr_cast(dst);
     if(!pimpl_->isAPointer(realPtr)) signalIllegalStore(realPtr);
 
-    pimpl_->tree.memset(realPtr, fill, size);
+    pimpl_->memory->memset(realPtr, fill, size);
 }
 
 MemorySimulator::MemorySimulator(const llvm::DataLayout& dl) : pimpl_{new Impl{dl}} {}
@@ -0,0 +1,225 @@
+/*
+ * PagedMemoryImpl.cpp
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "Executor/MemorySimulator/PagedMemoryImpl.h"
+
+#include "Logging/tracer.hpp"
+
+#include "Util/macros.h"
+
+namespace borealis {
+
+namespace {
+
+using bitmap = std::vector<uint64_t>;
+
+template<class F>
+void forEachWord(SimulatedPtrSize from, SimulatedPtrSize size, F&& f) {
+    while (size > 0) {
+        auto bit = from % 64;
+        auto count = std::min<SimulatedPtrSize>(size, 64 - bit);
+        auto mask = (count == 64) ? ~uint64_t(0) : (((uint64_t(1) << count) - 1) << bit);
+        f(from / 64, mask);
+        from += count;
+        size -= count;
+    }
+}
+
+void setBits(bitmap& bits, SimulatedPtrSize from, SimulatedPtrSize size) {
+    forEachWord(from, size, [&](size_t word, uint64_t mask) { bits[word] |= mask; });
+}
+
+void clearBits(bitmap& bits, SimulatedPtrSize from, SimulatedPtrSize size) {
+    forEachWord(from, size, [&](size_t word, uint64_t mask) { bits[word] &= ~mask; });
+}
+
+bool allBits(const bitmap& bits, SimulatedPtrSize from, SimulatedPtrSize size) {
+    bool result = true;
+    forEachWord(from, size, [&](size_t word, uint64_t mask) { result &= (bits[word] & mask) == mask; });
+    return result;
+}
+
+bool anyBits(const bitmap& bits, SimulatedPtrSize from, SimulatedPtrSize size) {
+    bool result = false;
+    forEachWord(from, size, [&](size_t word, uint64_t mask) { result |= (bits[word] & mask) != 0; });
+    return result;
+}
+
+bool testBit(const bitmap& bits, SimulatedPtrSize index) {
+    return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+} /* empty namespace */
+
+constexpr unsigned PagedMemory::TableBits;
+
+PagedMemory::Page::Page(SimulatedPtrSize size):
+    data{ new uint8_t[size] }, allocated((size + 63) / 64, 0), initialized((size + 63) / 64, 0) {}
+
+PagedMemory::PagedMemory(SimulatedPtr start, SimulatedPtr end, SimulatedPtrSize chunk_size, SimulatedPtrSize page_size) {
+    TRACE_FUNC;
+    this->start = start;
+    this->end = end;
+    this->chunk_size = chunk_size;
+    // chunks should never cross page borders
+    this->page_size = std::max(chunk_size, page_size - page_size % chunk_size);
+
+    auto numPages = ((end - start) + this->page_size - 1) / this->page_size;
+    directory.resize((numPages >> TableBits) + 1);
+}
+
+auto PagedMemory::findPage(SimulatedPtrSize offset) const -> Page* {
+    auto index = offset / page_size;
+    auto& table = directory[index >> TableBits];
+    if (!table) return nullptr;
+    return table->pages[index & ((1U << TableBits) - 1)].get();
+}
+
+auto PagedMemory::forcePage(SimulatedPtrSize offset) -> Page& {
+    auto index = offset / page_size;
+    auto& table = directory[index >> TableBits];
+    if (!table) {
+        table.reset(new PageTable{});
+        table->pages.resize(1U << TableBits);
+    }
+    auto& page = table->pages[index & ((1U << TableBits) - 1)];
+    if (!page) page.reset(new Page{ page_size });
+    return *page;
+}
+
+bool PagedMemory::isAllocated(SimulatedPtr where, SimulatedPtrSize size) const {
+    if (where < start || end < where + size) return false;
+
+    bool result = true;
+    forEachPiece(where, size, [&](SimulatedPtrSize offset, SimulatedPtrSize inPage, SimulatedPtrSize piece, SimulatedPtrSize) {
+        auto page = findPage(offset);
+        result = result && page && allBits(page->allocated, inPage, piece);
+    });
+    return result;
+}
+
+void PagedMemory::allocate(
+        SimulatedPtr where,
+        SimulatedPtrSize size,
+        SegmentNode::MemoryState state,
+        SegmentNode::MemoryStatus status) {
+    TRACE_FUNC;
+    TRACE_PARAM(where);
+    TRACE_PARAM(size);
+
+    if (size > (end - start) || end < where + size) signalOutOfMemory(size);
+
+    forEachPiece(where, size, [&](SimulatedPtrSize offset, SimulatedPtrSize inPage, SimulatedPtrSize piece, SimulatedPtrSize) {
+        auto& page = forcePage(offset);
+        if (anyBits(page.allocated, inPage, piece)) {
+            signalInconsistency("Allocated segment inside other allocated segment detected");
+        }
+
+        setBits(page.allocated, inPage, piece);
+        page.allocatedBytes += piece;
+        if (state == SegmentNode::MemoryState::Memset) {
+            std::memset(page.data.get() + inPage, 0, piece);
+            setBits(page.initialized, inPage, piece);
+        } else {
+            clearBits(page.initialized, inPage, piece);
+        }
+    });
+
+    allocations[where - start] = Allocation{ size, status };
+}
+
+void PagedMemory::store(SimulatedPtr where, const uint8_t* data, SimulatedPtrSize size) {
+    TRACE_FUNC;
+    TRACE_PARAM(where);
+    TRACE_PARAM(size);
+
+    if (!isAllocated(where, size)) signalIllegalStore(where);
+
+    forEachPiece(where, size, [&](SimulatedPtrSize offset, SimulatedPtrSize inPage, SimulatedPtrSize piece, SimulatedPtrSize done) {
+        auto page = findPage(offset);
+        std::memcpy(page->data.get() + inPage, data + done, piece);
+        setBits(page->initialized, inPage, piece);
+    });
+}
+
+auto PagedMemory::get(SimulatedPtr where, SimulatedPtrSize size) -> intervalState {
+    TRACE_FUNC;
+    TRACE_PARAM(where);
+    TRACE_PARAM(size);
+
+    if (!isAllocated(where, size)) signalIllegalLoad(where);
+
+    auto offset = where - start;
+    auto inPage = offset % page_size;
+    ASSERT(inPage + size <= page_size, "Load crosses page border");
+
+    auto page = findPage(offset);
+    if (allBits(page->initialized, inPage, size)) {
+        return { page->data.get() + inPage, SegmentNode::MemoryState::Unknown, 0 };
+    }
+    // partially initialized values are unknown as well
+    return { nullptr, SegmentNode::MemoryState::Uninit, 0xFF };
+}
+
+SimulatedPtr PagedMemory::memchr(SimulatedPtr where, uint8_t ch, size_t limit) {
+    TRACE_FUNC;
+    TRACE_PARAM(where);
+    TRACE_PARAM(+ch);
+    TRACE_PARAM(limit);
+
+    for (size_t i = 0; i < limit; ++i) {
+        auto current = where + i;
+        if (current < start || end <= current) signalIllegalLoad(current);
+
+        auto offset = current - start;
+        auto inPage = offset % page_size;
+        auto page = findPage(offset);
+        if (!page || !testBit(page->allocated, inPage)) signalIllegalLoad(current);
+        if (!testBit(page->initialized, inPage)) signalIllegalLoad(current);
+
+        if (page->data[inPage] == ch) return current;
+    }
+    return SimulatedPtr::Null;
+}
+
+void PagedMemory::free(SimulatedPtr where, SegmentNode::MemoryStatus desiredStatus) {
+    TRACE_FUNC;
+    TRACE_PARAM(where);
+
+    if (where < start || end <= where) signalIllegalFree(where);
+
+    auto it = allocations.find(where - start);
+    if (it == allocations.end() || it->second.status != desiredStatus) signalIllegalFree(where);
+
+    forEachPiece(where, it->second.size, [&](SimulatedPtrSize offset, SimulatedPtrSize inPage, SimulatedPtrSize piece, SimulatedPtrSize) {
+        auto index = offset / page_size;
+        auto& page = directory[index >> TableBits]->pages[index & ((1U << TableBits) - 1)];
+        clearBits(page->allocated, inPage, piece);
+        clearBits(page->initialized, inPage, piece);
+        page->allocatedBytes -= piece;
+        if (page->allocatedBytes == 0) page.reset();
+    });
+    allocations.erase(it);
+}
+
+void PagedMemory::memset(SimulatedPtr where, uint8_t fill, SimulatedPtrSize size) {
+    TRACE_FUNC;
+    TRACE_PARAM(where);
+    TRACE_PARAM(size);
+
+    if (!isAllocated(where, size)) signalIllegalStore(where);
+
+    forEachPiece(where, size, [&](SimulatedPtrSize offset, SimulatedPtrSize inPage, SimulatedPtrSize piece, SimulatedPtrSize) {
+        auto page = findPage(offset);
+        std::memset(page->data.get() + inPage, fill, piece);
+        setBits(page->initialized, inPage, piece);
+    });
+}
+
+} /* namespace borealis */
+
+#include "Util/unmacros.h"
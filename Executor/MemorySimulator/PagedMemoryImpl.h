@@ -0,0 +1,85 @@
+/*
+ * PagedMemoryImpl.h
+ */
+
+#ifndef EXECUTOR_MEMORYSIMULATOR_PAGEDMEMORYIMPL_H_
+#define EXECUTOR_MEMORYSIMULATOR_PAGEDMEMORYIMPL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Executor/MemorySimulator/SegmentTreeImpl.h"
+
+#include "Util/macros.h"
+
+namespace borealis {
+
+// Simulated memory as a two-level page table over lazily allocated pages.
+// Every page keeps bitmaps of allocated and initialized bytes,
+// so any access is checked in constant time without walking a tree
+struct PagedMemory: MemoryBackend {
+
+    struct Page {
+        std::unique_ptr<uint8_t[]> data;
+        std::vector<uint64_t> allocated;
+        std::vector<uint64_t> initialized;
+        SimulatedPtrSize allocatedBytes = 0U;
+
+        explicit Page(SimulatedPtrSize size);
+    };
+
+    struct PageTable {
+        std::vector<std::unique_ptr<Page>> pages;
+    };
+
+    struct Allocation {
+        SimulatedPtrSize size;
+        SegmentNode::MemoryStatus status;
+    };
+
+    static constexpr unsigned TableBits = 10;
+
+    SimulatedPtrSize page_size;
+    std::vector<std::unique_ptr<PageTable>> directory;
+    std::unordered_map<SimulatedPtrSize, Allocation> allocations;
+
+    PagedMemory(SimulatedPtr start, SimulatedPtr end, SimulatedPtrSize chunk_size, SimulatedPtrSize page_size);
+
+    void allocate(SimulatedPtr where, SimulatedPtrSize size,
+        SegmentNode::MemoryState state, SegmentNode::MemoryStatus status) override;
+    void store(SimulatedPtr where, const uint8_t* data, SimulatedPtrSize size) override;
+    intervalState get(SimulatedPtr where, SimulatedPtrSize size) override;
+    SimulatedPtr memchr(SimulatedPtr where, uint8_t ch, size_t limit) override;
+    void free(SimulatedPtr where, SegmentNode::MemoryStatus desiredStatus) override;
+    void memset(SimulatedPtr where, uint8_t fill, SimulatedPtrSize size) override;
+
+private:
+
+    // returns nullptr for pages that were never touched
+    Page* findPage(SimulatedPtrSize offset) const;
+    Page& forcePage(SimulatedPtrSize offset);
+
+    // calls @f(offset, offsetInPage, pieceSize, doneSoFar) for every page piece of [where, where + size)
+    template<class F>
+    void forEachPiece(SimulatedPtr where, SimulatedPtrSize size, F&& f) const {
+        auto offset = where - start;
+        SimulatedPtrSize done = 0U;
+        while (done < size) {
+            auto inPage = (offset + done) % page_size;
+            auto piece = std::min(size - done, page_size - inPage);
+            f(offset + done, inPage, piece, done);
+            done += piece;
+        }
+    }
+
+    bool isAllocated(SimulatedPtr where, SimulatedPtrSize size) const;
+};
+
+} /* namespace borealis */
+
+#include "Util/unmacros.h"
+
+#endif /* EXECUTOR_MEMORYSIMULATOR_PAGEDMEMORYIMPL_H_ */
@@ -371,7 +371,7 @@ void SegmentTree::store(
     return traverse(where, storeTraverser{ data, size, false });
 }
 
-SegmentTree::intervalState SegmentTree::get(SimulatedPtr where) {
+SegmentTree::intervalState SegmentTree::get(SimulatedPtr where, SimulatedPtrSize /* size */) {
     TRACE_FUNC;
 
     loadTraverser loadTraverser;
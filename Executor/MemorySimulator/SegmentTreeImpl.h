@@ -194,10 +194,31 @@ struct stateInvalidatingTraverser: emptyTraverser {
     }
 };
 
-struct SegmentTree {
+// Simulated address space [start, end), accessed by chunks of chunk_size bytes
+struct MemoryBackend {
     SimulatedPtr start;
     SimulatedPtr end;
     SimulatedPtrSize chunk_size;
+
+    struct intervalState {
+        uint8_t* data;
+        SegmentNode::MemoryState memState;
+        uint8_t filledWith;
+    };
+
+    virtual ~MemoryBackend() = default;
+
+    virtual void allocate(SimulatedPtr where, SimulatedPtrSize size,
+        SegmentNode::MemoryState state, SegmentNode::MemoryStatus status) = 0;
+    virtual void store(SimulatedPtr where, const uint8_t* data, SimulatedPtrSize size) = 0;
+    // @size bytes starting from @where should fit into one chunk
+    virtual intervalState get(SimulatedPtr where, SimulatedPtrSize size) = 0;
+    virtual SimulatedPtr memchr(SimulatedPtr where, uint8_t ch, size_t limit) = 0;
+    virtual void free(SimulatedPtr where, SegmentNode::MemoryStatus desiredStatus) = 0;
+    virtual void memset(SimulatedPtr where, uint8_t fill, SimulatedPtrSize size) = 0;
+};
+
+struct SegmentTree: MemoryBackend {
     SegmentNode::Ptr root = nullptr;
 
 
@@ -259,19 +280,13 @@ struct SegmentTree {
         }
     }
 
-    struct intervalState {
-        uint8_t* data;
-        SegmentNode::MemoryState memState;
-        uint8_t filledWith;
-    };
-
     void allocate(SimulatedPtr where, SimulatedPtrSize size,
-        SegmentNode::MemoryState state, SegmentNode::MemoryStatus status);
-    void store(SimulatedPtr where, const uint8_t* data, SimulatedPtrSize size);
-    intervalState get(SimulatedPtr where);
-    SimulatedPtr memchr(SimulatedPtr where, uint8_t ch, size_t limit);
-    void free(SimulatedPtr where, SegmentNode::MemoryStatus desiredStatus);
-    void memset(SimulatedPtr where, uint8_t fill, SimulatedPtrSize size);
+        SegmentNode::MemoryState state, SegmentNode::MemoryStatus status) override;
+    void store(SimulatedPtr where, const uint8_t* data, SimulatedPtrSize size) override;
+    intervalState get(SimulatedPtr where, SimulatedPtrSize size) override;
+    SimulatedPtr memchr(SimulatedPtr where, uint8_t ch, size_t limit) override;
+    void free(SimulatedPtr where, SegmentNode::MemoryStatus desiredStatus) override;
+    void memset(SimulatedPtr where, uint8_t fill, SimulatedPtrSize size) override;
 
     struct memIntervalInfo {
         uint8_t* data;
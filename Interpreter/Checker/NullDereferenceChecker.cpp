@@ -49,13 +49,14 @@ void NullDereferenceChecker::checkPointer(llvm::Instruction& loc, llvm::Value& p
 
     } else {
         auto&& ptrDomain = module_->getDomainFor(&ptr, loc.getParent());
-        auto&& ptr = llvm::dyn_cast<AbstractFactory::PointerT>(ptrDomain.get());
-        auto bug = ptr->isTop() || ptr->isBottom() || ptr->pointsToNull();
+        auto&& pointer = llvm::dyn_cast<AbstractFactory::PointerT>(ptrDomain.get());
+        auto bug = pointer->isTop() || pointer->isBottom() || pointer->pointsToNull();
         if (enableLogging.get(true)) {
             info << "Pointer domain: " << ptrDomain << endl;
             info << "Result: " << bug << endl;
         }
         defects_[di] |= bug;
+        if (not bug) DM_->addAbsIntSafe(di, &ptr);
     }
 }
 
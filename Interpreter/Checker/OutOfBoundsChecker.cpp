@@ -54,6 +54,7 @@ void OutOfBoundsChecker::visitGEPOperator(llvm::Instruction& loc, llvm::GEPOpera
         }
         auto bug = OutOfBoundsVisitor().visit(ptr, offsets);
         defects_[di] |= bug;
+        if (not bug) DM_->addAbsIntSafe(di, &GI);
 
         if (enableLogging.get(true)) {
             info << "Pointer operand: " << ptr << endl;
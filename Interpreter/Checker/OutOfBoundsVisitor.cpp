@@ -50,10 +50,8 @@ RetTy OutOfBoundsVisitor::visitArray(const AbstractFactory::ArrayT& array, const
 
     std::vector<AbstractDomain::Ptr> sub_idx(indices.begin() + 1, indices.end());
     if (sub_idx.empty()) return false;
-    for (auto i = bounds.first; i <= bounds.second; ++i) {
-        auto&& element = array.elements().find((size_t) i);
-        if (element == array.elements().end()) continue;
-        if (visit((*element).second, sub_idx)) return true;
+    for (auto&& element : array.elements(bounds.first, bounds.second)) {
+        if (visit(element, sub_idx)) return true;
     }
 
     return false;
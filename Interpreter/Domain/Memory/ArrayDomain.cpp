@@ -0,0 +1,24 @@
+//
+// ArrayDomain.cpp
+//
+
+#include "Config/config.h"
+#include "Interpreter/Domain/Memory/PointerDomain.hpp"
+#include "Interpreter/Domain/Memory/ArrayDomain.hpp"
+
+#include "Util/macros.h"
+
+namespace borealis {
+namespace absint {
+
+static config::IntConfigEntry maxSegments("absint", "array-max-segments");
+
+size_t arrayMaxSegments() {
+    static auto max = maxSegments.get(64);
+    return (size_t) std::max(max, 1);
+}
+
+} // namespace absint
+} // namespace borealis
+
+#include "Util/unmacros.h"
@@ -5,11 +5,13 @@
 #ifndef BOREALIS_ARRAYDOMAIN_HPP
 #define BOREALIS_ARRAYDOMAIN_HPP
 
-#include <unordered_map>
+#include <limits>
+#include <map>
 
 #include "Interpreter/Domain/AbstractDomain.hpp"
 #include "Interpreter/Domain/AbstractFactory.hpp"
 #include "PointerDomain.hpp"
+#include "StructDomain.hpp"
 
 #include "Util/collections.hpp"
 #include "Util/sayonara.hpp"
@@ -18,6 +20,12 @@
 namespace borealis {
 namespace absint {
 
+/// absint.array-max-segments, at least 1
+size_t arrayMaxSegments();
+
+/// Array is represented as a set of disjoint segments of indices, each sharing one abstract value.
+/// Indices that are not covered by any segment are bottom. If number of segments exceeds
+/// the limit, trailing segments are smashed into one, so leading indices stay precise
 template <typename MachineInt>
 class ArrayDomain : public AbstractDomain {
 public:
@@ -27,14 +35,22 @@ public:
 
     using Self = ArrayDomain<MachineInt>;
     using IntervalT = Interval<MachineInt>;
-    using ElementMapT = std::unordered_map<size_t, AbstractDomain::Ptr>;
+
+    /// Segment [begin, end), begin is stored as a key in SegmentMapT
+    struct Segment {
+        size_t end;
+        AbstractDomain::Ptr value;
+    };
+    using SegmentMapT = std::map<size_t, Segment>;
+    /// Closed range of indices
+    using IndexRange = std::pair<size_t, size_t>;
 
 private:
 
     AbstractFactory* factory_;
     Ptr length_;
     Type::Ptr elementType_;
-    ElementMapT elements_;
+    SegmentMapT segments_;
 
 private:
 
@@ -52,6 +68,113 @@ private:
         return otherRaw;
     }
 
+    /// Nested arrays and structs may be referred to by pointers made with gep,
+    /// so they must stay the same objects while they are in the array
+    static bool isReferable(ConstPtr value) {
+        return llvm::isa<Self>(value.get()) || llvm::isa<StructDomain<MachineInt>>(value.get());
+    }
+
+    /// Joins @value into @target, nested arrays and structs are joined in place
+    static void joinInPlace(Ptr& target, ConstPtr value) {
+        if (auto* array = llvm::dyn_cast<Self>(target.get())) {
+            array->joinWith(value);
+        } else if (auto* structure = llvm::dyn_cast<StructDomain<MachineInt>>(target.get())) {
+            structure->joinWith(value);
+        } else {
+            target = target->join(value);
+        }
+    }
+
+    /// Makes @index a segment boundary, both parts share the value of the split segment
+    static void split(SegmentMapT& segments, size_t index) {
+        auto&& it = segments.upper_bound(index);
+        if (it == segments.begin()) return;
+        --it;
+
+        auto& segment = it->second;
+        if (it->first == index || segment.end <= index) return;
+
+        segments.insert({ index, Segment{ segment.end, segment.value } });
+        segment.end = index;
+    }
+
+    /// Makes every segment boundary of @rhv a boundary in @lhv and vice versa
+    static void align(SegmentMapT& lhv, SegmentMapT& rhv) {
+        std::vector<size_t> bounds;
+        for (auto&& it : lhv) {
+            bounds.push_back(it.first);
+            bounds.push_back(it.second.end);
+        }
+        for (auto&& it : rhv) {
+            bounds.push_back(it.first);
+            bounds.push_back(it.second.end);
+        }
+
+        for (auto&& it : bounds) {
+            split(lhv, it);
+            split(rhv, it);
+        }
+    }
+
+    util::option<IndexRange> clamp(const Bound<size_t>& lb, const Bound<size_t>& ub) const {
+        auto&& length = this->length();
+        if (length.isFinite() && length.isZero()) return util::nothing();
+
+        auto first = lb.isFinite() ? (size_t) lb : 0;
+        auto last = std::numeric_limits<size_t>::max() - 1;
+        if (ub.isFinite()) last = std::min(last, (size_t) ub);
+        if (length.isFinite()) last = std::min(last, (size_t) length - 1);
+
+        if (first > last) return util::nothing();
+        return util::just(IndexRange{ first, last });
+    }
+
+    /// Merges adjacent equal segments and smashes the tail, if there are too many segments.
+    /// Segments with referable values are merged only if they share the value
+    void normalize() {
+        for (auto it = segments_.begin(); it != segments_.end();) {
+            auto next = std::next(it);
+            if (next == segments_.end()) break;
+
+            auto&& lhv = it->second.value;
+            auto&& rhv = next->second.value;
+            auto sameValue = lhv == rhv || (not isReferable(lhv) && not isReferable(rhv) && lhv->equals(rhv));
+            if (it->second.end == next->first && sameValue) {
+                it->second.end = next->second.end;
+                segments_.erase(next);
+            } else {
+                it = next;
+            }
+        }
+
+        if (segments_.size() <= arrayMaxSegments()) return;
+
+        auto&& smashed = std::next(segments_.begin(), arrayMaxSegments() - 1);
+        auto& result = smashed->second;
+        for (auto it = std::next(smashed); it != segments_.end(); ++it) {
+            result.end = it->second.end;
+            if (result.value != it->second.value) joinInPlace(result.value, it->second.value);
+        }
+        segments_.erase(std::next(smashed), segments_.end());
+    }
+
+    /// Applies @op to every pair of aligned segments, segments present only in one of the arrays are kept as is
+    template <typename Op>
+    void mergeWith(const Self* other, Op&& op) {
+        auto otherSegments = other->segments_;
+        align(this->segments_, otherSegments);
+
+        for (auto&& it : otherSegments) {
+            auto&& cur = this->segments_.find(it.first);
+            if (cur == this->segments_.end()) {
+                this->segments_.insert(it);
+            } else {
+                cur->second.value = op(cur->second.value, it.second.value);
+            }
+        }
+        normalize();
+    }
+
 public:
     struct TopTag {};
     struct BottomTag {};
@@ -76,8 +199,9 @@ public:
             length_(factory_->getMachineInt(elements.size())),
             elementType_(elementType) {
         for (auto i = 0U; i < elements.size(); ++i) {
-            elements_[i] = elements[i];
+            segments_.insert(segments_.end(), { i, Segment{ i + 1, elements[i] } });
         }
+        normalize();
     }
 
     ArrayDomain(Type::Ptr elementType, Ptr length) :
@@ -91,7 +215,7 @@ public:
             this->length_ = other.length_;
             this->elementType_ = other.elementType_;
             this->factory_ = other.factory_;
-            this->elements_ = other.elements_;
+            this->segments_ = other.segments_;
         }
         return *this;
     }
@@ -115,8 +239,25 @@ public:
         return std::make_shared<ArrayDomain>(elementType, elements);
     }
 
-    const ElementMapT& elements() const {
-        return elements_;
+    const SegmentMapT& segments() const {
+        return segments_;
+    }
+
+    /// Values of all segments that intersect with indices [lb, ub]
+    std::vector<Ptr> elements(const Bound<size_t>& lb, const Bound<size_t>& ub) const {
+        std::vector<Ptr> result;
+
+        auto&& range = clamp(lb, ub);
+        if (not range) return result;
+        auto first = range.getUnsafe().first;
+        auto last = range.getUnsafe().second;
+
+        auto&& it = segments_.upper_bound(first);
+        if (it != segments_.begin() && std::prev(it)->second.end > first) --it;
+        for (; it != segments_.end() && it->first <= last; ++it) {
+            result.push_back(it->second.value);
+        }
+        return result;
     }
 
     Bound<size_t> length() const {
@@ -129,17 +270,17 @@ public:
 
     Type::Ptr elementType() const { return elementType_; }
 
-    bool isTop() const override { return length_->isTop() and elements_.empty(); }
-    bool isBottom() const override { return length_->isBottom() and elements_.empty(); }
+    bool isTop() const override { return length_->isTop() and segments_.empty(); }
+    bool isBottom() const override { return length_->isBottom() and segments_.empty(); }
 
     void setTop() override {
         length_ = factory_->getMachineInt(AbstractFactory::TOP);
-        elements_.clear();
+        segments_.clear();
     }
 
     void setBottom() override {
         length_->setBottom();
-        elements_.clear();
+        segments_.clear();
     }
 
     bool leq(ConstPtr) const override {
@@ -162,16 +303,14 @@ public:
 
             if (not this->length_->equals(otherRaw->length_)) return false;
 
-            for (auto&& it : this->elements_) {
-                auto&& opt = util::at(otherRaw->elements_, (size_t) it.first);
-                if ((not opt) || (not it.second->equals(opt.getUnsafe()))) {
-                    return false;
-                }
-            }
+            auto lhv = this->segments_;
+            auto rhv = otherRaw->segments_;
+            align(lhv, rhv);
+            if (lhv.size() != rhv.size()) return false;
 
-            for (auto&& it : otherRaw->elements_) {
-                auto&& opt = util::at(this->elements_, (size_t) it.first);
-                if ((not opt) || (not it.second->equals(opt.getUnsafe()))) {
+            for (auto&& it : lhv) {
+                auto&& opt = util::at(rhv, it.first);
+                if ((not opt) || (not it.second.value->equals(opt.getUnsafe().value))) {
                     return false;
                 }
             }
@@ -195,14 +334,7 @@ public:
         } else {
 
             this->length_ = this->length_->join(otherRaw->length_);
-            for (auto&& it : otherRaw->elements_) {
-                auto&& opt = util::at(this->elements_, (size_t) it.first);
-                if (not opt) {
-                    this->elements_[it.first] = it.second;
-                } else {
-                    this->elements_[it.first] = it.second->join(opt.getUnsafe());
-                }
-            }
+            mergeWith(otherRaw, [](Ptr lhv, Ptr rhv) { return rhv->join(lhv); });
         }
     }
 
@@ -226,14 +358,7 @@ public:
         } else {
 
             this->length_ = this->length_->meet(otherRaw->length_);
-            for (auto&& it : otherRaw->elements_) {
-                auto&& opt = util::at(this->elements_, (size_t) it.first);
-                if (not opt) {
-                    this->elements_[it.first] = it.second;
-                } else {
-                    this->elements_[it.first] = it.second->meet(opt.getUnsafe());
-                }
-            }
+            mergeWith(otherRaw, [](Ptr lhv, Ptr rhv) { return rhv->meet(lhv); });
         }
     }
 
@@ -257,14 +382,7 @@ public:
         } else {
 
             this->length_ = this->length_->widen(otherRaw->length_);
-            for (auto&& it : otherRaw->elements_) {
-                auto&& opt = util::at(this->elements_, (size_t) it.first);
-                if (not opt) {
-                    this->elements_[it.first] = it.second;
-                } else {
-                    this->elements_[it.first] = it.second->widen(opt.getUnsafe());
-                }
-            }
+            mergeWith(otherRaw, [](Ptr lhv, Ptr rhv) { return rhv->widen(lhv); });
         }
     }
 
@@ -287,8 +405,11 @@ public:
         } else if (this->isBottom()) {
             ss << " BOTTOM ]";
         } else {
-            for (auto&& it : this->elements_) {
-                ss << std::endl << "  " << it.first << " : " << it.second->toString();
+            for (auto&& it : this->segments_) {
+                ss << std::endl << "  ";
+                if (it.second.end == it.first + 1) ss << it.first;
+                else ss << "[" << it.first << ", " << it.second.end << ")";
+                ss << " : " << it.second.value->toString();
             }
             ss << std::endl << "]";
         }
@@ -317,9 +438,9 @@ public:
                 return factory_->top(elementType_);
             }
 
-            for (auto i = lb; i <= ub and i < length; ++i) {
-                auto&& opt = util::at(this->elements_, (size_t) i);
-                result = result->join((not opt) ? factory_->bottom(elementType_) : opt.getUnsafe());
+            // indices that are not covered by any segment are bottom
+            for (auto&& it : elements(lb, ub)) {
+                result = result->join(it);
             }
 
             return result;
@@ -334,7 +455,6 @@ public:
         } else if (this->isBottom()) {
             return;
         } else {
-            auto&& length = this->length();
             auto&& lb = bounds.first;
             auto&& ub = bounds.second;
 
@@ -344,11 +464,28 @@ public:
 //                warns() << "Buffer overflow" << endl;
 //            }
 
-            for (auto i = lb; i <= ub and i < length; ++i) {
-                auto&& opt = util::at(this->elements_, (size_t) i);
-                Ptr storage = not opt ? value : opt.getUnsafe()->join(value);
-                this->elements_[(size_t) i] = storage;
+            auto&& range = clamp(lb, ub);
+            if (not range) return;
+            auto first = range.getUnsafe().first;
+            auto last = range.getUnsafe().second;
+
+            split(segments_, first);
+            split(segments_, last + 1);
+
+            auto current = first;
+            auto&& it = segments_.lower_bound(first);
+            while (current <= last) {
+                if (it == segments_.end() || it->first > current) {
+                    auto gapEnd = (it == segments_.end()) ? last + 1 : std::min(it->first, last + 1);
+                    segments_.insert(it, { current, Segment{ gapEnd, value } });
+                    current = gapEnd;
+                } else {
+                    it->second.value = it->second.value->join(value);
+                    current = it->second.end;
+                    ++it;
+                }
             }
+            normalize();
         }
     }
 
@@ -360,7 +497,6 @@ public:
         }
 
         auto&& bounds = factory_->unsignedBounds(offsets[0]);
-        auto&& length = this->length();
         auto&& idx_begin = bounds.first;
         auto&& idx_end = bounds.second;
 
@@ -376,13 +512,27 @@ public:
         } else {
             Ptr result = factory_->bottom(type);
 
-            std::vector<Ptr> sub_idx(offsets.begin() + 1, offsets.end());
-            for (auto i = idx_begin; i <= idx_end && i < length; ++i) {
-                if (not util::at(elements_, (size_t) i)) {
-                    elements_[(size_t) i] = factory_->bottom(elementType_);
+            auto&& range = clamp(idx_begin, idx_end);
+            if (range) {
+                auto first = range.getUnsafe().first;
+                auto last = range.getUnsafe().second;
+
+                split(segments_, first);
+                split(segments_, last + 1);
+
+                std::vector<Ptr> sub_idx(offsets.begin() + 1, offsets.end());
+                auto current = first;
+                auto&& it = segments_.lower_bound(first);
+                while (current <= last) {
+                    if (it == segments_.end() || it->first > current) {
+                        auto gapEnd = (it == segments_.end()) ? last + 1 : std::min(it->first, last + 1);
+                        it = segments_.insert(it, { current, Segment{ gapEnd, factory_->bottom(elementType_) } });
+                    }
+                    auto subGep = it->second.value->gep(type, sub_idx);
+                    result = result->join(subGep);
+                    current = it->second.end;
+                    ++it;
                 }
-                auto subGep = elements_[(size_t) i]->gep(type, sub_idx);
-                result = result->join(subGep);
             }
             if (not result) {
                 warns() << "Gep is out of bounds" << endl;
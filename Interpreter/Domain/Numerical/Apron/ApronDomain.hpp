@@ -136,45 +136,40 @@ inline ap_texpr0_t* toAExpr(const mpq_class& n) {
     return ap_texpr0_cst_scalar_mpq(const_cast<mpq_class&>(n).get_mpq_t());
 }
 
+inline mpq_class toGMP(ap_scalar_t* scalar) {
+    ASSERTC(ap_scalar_infty(scalar) == 0);
+
+    switch (scalar->discr) {
+        case AP_SCALAR_MPQ:
+            return mpq_class(scalar->val.mpq);
+        case AP_SCALAR_DOUBLE:
+            return mpq_class(scalar->val.dbl);
+        default:
+            UNREACHABLE("Unsupported apron scalar");
+    }
+}
+
 template <typename Number>
 inline Number toBNumber(ap_scalar_t*, const util::Adapter<Number>* caster);
 
 template <>
 inline BitInt<true> toBNumber(ap_scalar_t* scalar, const util::Adapter<BitInt<true>>* caster) {
-    ASSERTC(ap_scalar_infty(scalar) == 0);
-//    ASSERTC(scalar->discr == AP_SCALAR_MPQ);
-
-    auto q = mpq_class(scalar->val.dbl);
-
-//    std::stringstream ss;
-//    ss << q;
-
-    return (*caster)(q.get_d());
+    return (*caster)(mpz_class(toGMP(scalar)));
 }
 
 template <>
 inline BitInt<false> toBNumber(ap_scalar_t* scalar, const util::Adapter<BitInt<false>>* caster) {
-    ASSERTC(ap_scalar_infty(scalar) == 0);
-//    ASSERTC(scalar->discr == AP_SCALAR_MPQ);
-
-    auto q = mpq_class(scalar->val.dbl);
-
-//    std::stringstream ss;
-//    ss << q;
-
-    return (*caster)(q.get_d());
+    return (*caster)(mpz_class(toGMP(scalar)));
 }
 
 template <>
 inline Float toBNumber(ap_scalar_t* scalar, const util::Adapter<Float>* caster) {
-    ASSERTC(ap_scalar_infty(scalar) == 0);
-    ASSERTC(scalar->discr == AP_SCALAR_MPQ);
-
-    auto q = mpq_class(scalar->val.mpq);
-    std::stringstream ss;
-    ss << q;
+    return (*caster)(toGMP(scalar).get_d());
+}
 
-    return (*caster)(ss.str());
+template <>
+inline mpq_class toBNumber(ap_scalar_t* scalar, const util::Adapter<mpq_class>*) {
+    return toGMP(scalar);
 }
 
 template <typename Number>
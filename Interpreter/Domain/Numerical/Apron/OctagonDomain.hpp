@@ -8,14 +8,18 @@
 #include <unordered_map>
 
 #include "DoubleOctagon.hpp"
+#include "VariablePacks.hpp"
 #include "Interpreter/Domain/AbstractFactory.hpp"
 
+#include "Util/hash.hpp"
 #include "Util/sayonara.hpp"
 #include "Util/macros.h"
 
 namespace borealis {
 namespace absint {
 
+/// Keeps a separate octagon for each (bitsize, variable pack) pair.
+/// Without packing all the variables of the same bitsize share one octagon
 template <typename N1, typename N2, typename Variable, typename VarHash, typename VarEquals>
 class OctagonDomain : public NumericalDomain<Variable> {
 public:
@@ -23,12 +27,16 @@ public:
     using Ptr = AbstractDomain::Ptr;
     using ConstPtr = AbstractDomain::ConstPtr;
     using DOctagon = DoubleOctagon<N1, N2, Variable, VarHash, VarEquals>;
-    using OctagonMap = std::unordered_map<size_t, Ptr>;
+    /// (bitsize, pack)
+    using OctagonKey = std::pair<size_t, size_t>;
+    using OctagonMap = std::unordered_map<OctagonKey, Ptr>;
+    using PacksT = VariablePacks<Variable, VarHash, VarEquals>;
     using Self = OctagonDomain<N1, N2, Variable, VarHash, VarEquals>;
 
 protected:
 
     mutable OctagonMap octagons_;
+    typename PacksT::Ptr packs_;
     bool isBottom_;
 
 private:
@@ -51,15 +59,30 @@ protected:
 
     virtual size_t unwrapTypeSize(Variable x) const = 0;
 
-    DOctagon* unwrapOctagon(size_t bitsize) const {
-        auto&& opt = util::at(octagons_, bitsize);
+    size_t unwrapPack(Variable x) const {
+        return packs_ ? packs_->getPack(x) : PacksT::DEFAULT_PACK;
+    }
+
+    OctagonKey unwrapKey(Variable x) const {
+        return { unwrapTypeSize(x), unwrapPack(x) };
+    }
+
+    /// Variables from different packs are not tracked relationally,
+    /// operations over them should fall back to intervals
+    bool inSamePack(Variable x, Variable y) const {
+        return unwrapPack(x) == unwrapPack(y);
+    }
+
+    DOctagon* unwrapOctagon(const OctagonKey& key) const {
+        auto&& opt = util::at(octagons_, key);
 
         AbstractDomain::Ptr octagon;
         if (opt) {
             octagon = opt.getUnsafe();
         } else {
+            auto bitsize = key.first;
             octagon = DOctagon::top(util::Adapter<N1>::get(bitsize), util::Adapter<N2>::get(bitsize));
-            octagons_[bitsize] = octagon;
+            octagons_[key] = octagon;
         }
 
         auto* octagonRaw = llvm::dyn_cast<DOctagon>(octagon.get());
@@ -67,14 +90,20 @@ protected:
         return octagonRaw;
     }
 
+    DOctagon* unwrapOctagon(Variable x) const {
+        return unwrapOctagon(unwrapKey(x));
+    }
+
 public:
     struct TopTag{};
     struct BottomTag{};
 
-    explicit OctagonDomain(TopTag) : NumericalDomain<Variable>(class_tag(*this)), isBottom_(false) {}
-    explicit OctagonDomain(BottomTag) : NumericalDomain<Variable>(class_tag(*this)), isBottom_(true) {}
+    explicit OctagonDomain(TopTag, typename PacksT::Ptr packs = nullptr)
+            : NumericalDomain<Variable>(class_tag(*this)), packs_(packs), isBottom_(false) {}
+    explicit OctagonDomain(BottomTag, typename PacksT::Ptr packs = nullptr)
+            : NumericalDomain<Variable>(class_tag(*this)), packs_(packs), isBottom_(true) {}
 
-    OctagonDomain() : OctagonDomain(BottomTag{}) {}
+    explicit OctagonDomain(typename PacksT::Ptr packs = nullptr) : OctagonDomain(BottomTag{}, packs) {}
 
     OctagonDomain(const OctagonDomain&) = default;
     OctagonDomain(OctagonDomain&&) = default;
@@ -84,6 +113,7 @@ public:
     OctagonDomain& operator=(const OctagonDomain& other) {
         if (this != &other) {
             this->octagons_ = other.octagons_;
+            this->packs_ = other.packs_;
             this->isBottom_ = other.isBottom_;
         }
         return *this;
@@ -217,21 +247,23 @@ public:
     Ptr toInterval(Variable x) const override { return this->get(x); }
 
     bool contains(Variable x) const override {
-        auto bitsize = unwrapTypeSize(x);
-        auto* octagon = unwrapOctagon(bitsize);
+        auto* octagon = unwrapOctagon(x);
         return octagon->contains(x);
     }
 
     void set(Variable x, Ptr value) {
-        auto bitsize = unwrapTypeSize(x);
-        auto* octagon = unwrapOctagon(bitsize);
+        auto* octagon = unwrapOctagon(x);
         octagon->assign(x, value);
         this->isBottom_ = false;
     }
 
     void assign(Variable x, Variable y) override {
-        auto bitsize = unwrapTypeSize(x);
-        auto* octagon = unwrapOctagon(bitsize);
+        if (not inSamePack(x, y)) {
+            set(x, unwrapOctagon(y)->toInterval(y));
+            return;
+        }
+
+        auto* octagon = unwrapOctagon(x);
         octagon->assign(x, y);
         this->isBottom_ = false;
     }
@@ -241,20 +273,33 @@ public:
     }
 
     virtual void applyTo(llvm::ArithType op, Variable x, Variable y, Variable z) override {
-        auto bitsize = unwrapTypeSize(x);
-        auto* octagon = unwrapOctagon(bitsize);
+        if (not inSamePack(x, y) || not inSamePack(x, z)) {
+            auto&& lhv = unwrapOctagon(y)->toInterval(y);
+            auto&& rhv = unwrapOctagon(z)->toInterval(z);
+            set(x, lhv->apply(op, rhv));
+            return;
+        }
+
+        auto* octagon = unwrapOctagon(x);
         octagon->applyTo(op, x, y, z);
     }
 
     virtual Ptr applyTo(llvm::ConditionType op, Variable x, Variable y) override {
-        auto bitsize = unwrapTypeSize(x);
-        auto* octagon = unwrapOctagon(bitsize);
+        if (not inSamePack(x, y)) {
+            auto&& lhv = unwrapOctagon(x)->toInterval(x);
+            auto&& rhv = unwrapOctagon(y)->toInterval(y);
+            return lhv->apply(op, rhv);
+        }
+
+        auto* octagon = unwrapOctagon(x);
         return octagon->applyTo(op, x, y);
     }
 
     virtual void addConstraint(llvm::ConditionType op, Variable x, Variable y) override {
-        auto bitsize = unwrapTypeSize(x);
-        auto* octagon = unwrapOctagon(bitsize);
+        // constraints between different packs are dropped, which is sound, but imprecise
+        if (not inSamePack(x, y)) return;
+
+        auto* octagon = unwrapOctagon(x);
         octagon->addConstraint(op, x, y);
     }
 
@@ -265,7 +310,9 @@ public:
     std::string toString() const override {
         std::stringstream ss;
         for (auto&& it : octagons_) {
-            ss << "Bitsize " << it.first << std::endl;
+            ss << "Bitsize " << it.first.first;
+            if (packs_) ss << ", pack " << it.first.second;
+            ss << std::endl;
             ss << it.second->toString();
         }
         return ss.str();
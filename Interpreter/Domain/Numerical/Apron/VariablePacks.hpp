@@ -0,0 +1,147 @@
+//
+// VariablePacks.hpp
+//
+
+#ifndef BOREALIS_VARIABLEPACKS_HPP
+#define BOREALIS_VARIABLEPACKS_HPP
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Util/collections.hpp"
+
+#include "Util/macros.h"
+
+namespace borealis {
+namespace absint {
+
+/// Partition of function variables into small packs of syntactically related variables.
+/// Relational domains keep one instance per pack instead of one instance over all variables,
+/// so operations cost is cubic only in the size of the largest pack.
+/// Variables that were never added share the default pack.
+template <typename Variable, typename VarHash = std::hash<Variable>, typename VarEquals = std::equal_to<Variable>>
+class VariablePacks {
+public:
+
+    using Ptr = std::shared_ptr<const VariablePacks>;
+
+    static constexpr size_t DEFAULT_PACK = 0;
+
+private:
+
+    using IndexMap = std::unordered_map<Variable, size_t, VarHash, VarEquals>;
+
+    size_t maxPackSize_;
+    IndexMap indices_;
+    std::vector<size_t> parents_;
+    std::vector<size_t> sizes_;
+    /// dense pack ids, computed in finalize()
+    std::vector<size_t> packs_;
+    size_t numPacks_;
+
+private:
+
+    size_t find(size_t index) {
+        while (parents_[index] != index) {
+            parents_[index] = parents_[parents_[index]];
+            index = parents_[index];
+        }
+        return index;
+    }
+
+public:
+
+    explicit VariablePacks(size_t maxPackSize) : maxPackSize_(maxPackSize), numPacks_(0) {}
+    VariablePacks(const VariablePacks&) = default;
+    VariablePacks(VariablePacks&&) = default;
+    VariablePacks& operator=(const VariablePacks&) = default;
+    VariablePacks& operator=(VariablePacks&&) = default;
+
+    size_t add(Variable x) {
+        if (auto&& opt = util::at(indices_, x)) return opt.getUnsafe();
+
+        auto index = parents_.size();
+        indices_.insert({ x, index });
+        parents_.push_back(index);
+        sizes_.push_back(1);
+        return index;
+    }
+
+    /// Puts @x and @y into the same pack, unless resulting pack exceeds the size limit.
+    /// Returns true if variables are in the same pack after the call
+    bool relate(Variable x, Variable y) {
+        ASSERT(packs_.empty(), "Trying to update finalized packs");
+
+        auto xRoot = find(add(x));
+        auto yRoot = find(add(y));
+        if (xRoot == yRoot) return true;
+        if (sizes_[xRoot] + sizes_[yRoot] > maxPackSize_) return false;
+
+        if (sizes_[xRoot] < sizes_[yRoot]) std::swap(xRoot, yRoot);
+        parents_[yRoot] = xRoot;
+        sizes_[xRoot] += sizes_[yRoot];
+        return true;
+    }
+
+    template <class Container>
+    void relate(const Container& vars) {
+        auto&& it = std::begin(vars);
+        auto&& end = std::end(vars);
+        if (it == end) return;
+
+        auto&& first = *it;
+        add(first);
+        for (++it; it != end; ++it) relate(first, *it);
+    }
+
+    /// Assigns dense ids to packs, no more relations can be added after that
+    void finalize() {
+        std::unordered_map<size_t, size_t> ids;
+        packs_.resize(parents_.size());
+        for (auto i = 0U; i < parents_.size(); ++i) {
+            auto root = find(i);
+            auto&& it = ids.find(root);
+            if (it == ids.end()) {
+                // pack ids start from 1, 0 is reserved for the default pack
+                it = ids.insert({ root, ids.size() + 1 }).first;
+            }
+            packs_[i] = it->second;
+        }
+        numPacks_ = ids.size();
+    }
+
+    size_t getPack(Variable x) const {
+        ASSERT(packs_.size() == parents_.size(), "Trying to use non-finalized packs");
+
+        if (auto&& opt = util::at(indices_, x)) return packs_[opt.getUnsafe()];
+        return DEFAULT_PACK;
+    }
+
+    bool inSamePack(Variable x, Variable y) const {
+        return getPack(x) == getPack(y);
+    }
+
+    size_t getNumPacks() const {
+        return numPacks_;
+    }
+
+    size_t getNumVariables() const {
+        return indices_.size();
+    }
+
+    size_t getMaxPackSize() const {
+        return maxPackSize_;
+    }
+
+};
+
+template <typename Variable, typename VarHash, typename VarEquals>
+constexpr size_t VariablePacks<Variable, VarHash, VarEquals>::DEFAULT_PACK;
+
+} // namespace absint
+} // namespace borealis
+
+#include "Util/unmacros.h"
+
+#endif //BOREALIS_VARIABLEPACKS_HPP
@@ -445,6 +445,10 @@ public:
         return absint::BitInt<sign>(llvm::APInt(width_, str, 10));
     }
 
+    absint::BitInt<sign> operator()(const mpz_class& n) const {
+        return absint::BitInt<sign>(util::fromGMP(n, width_));
+    }
+
     absint::BitInt<sign> maxValue() const {
         return absint::BitInt<sign> { sign ? llvm::APInt::getSignedMaxValue(width_) : llvm::APInt::getMaxValue(width_) };
     }
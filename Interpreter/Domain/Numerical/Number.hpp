@@ -153,8 +153,7 @@ public:
     }
 
     mpz_class toGMP() const {
-        // This is generally fucked up, need to find new way to convert llvm::APInt to GMP
-        return mpz_class(toString());
+        return util::toGMP(inner_, sign);
     }
 
 private:
@@ -612,8 +611,9 @@ public:
     }
 
     mpq_class toGMP() const {
-        // This is generally fucked up, need to find new way to convert llvm::APFloat to GMP
-        return mpq_class(toString());
+        ASSERT(inner_.isFinite(), "Trying to convert non-finite float to GMP");
+        // inner_ always has IEEE double semantics, so conversion to double is exact
+        return mpq_class(inner_.convertToDouble());
     }
 
 private:
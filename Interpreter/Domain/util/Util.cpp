@@ -3,6 +3,7 @@
 //
 
 
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/Support/raw_ostream.h>
 #include <Logging/logger.hpp>
 
@@ -94,6 +95,39 @@ std::string toString(const llvm::APInt& val, bool isSigned) {
     return std::move(ss.str());
 }
 
+mpz_class toGMP(const llvm::APInt& val, bool isSigned) {
+    mpz_class result;
+    // most of the values fit into one machine word
+    if (val.getBitWidth() <= 64) {
+        if (isSigned) mpz_set_si(result.get_mpz_t(), val.getSExtValue());
+        else mpz_set_ui(result.get_mpz_t(), val.getZExtValue());
+        return result;
+    }
+
+    auto negative = isSigned && val.isNegative();
+    auto magnitude = negative ? -val : val;
+    // words are stored from the least significant one, in native endianness
+    mpz_import(result.get_mpz_t(), magnitude.getNumWords(), -1, sizeof(uint64_t), 0, 0, magnitude.getRawData());
+    if (negative) result = -result;
+    return result;
+}
+
+llvm::APInt fromGMP(const mpz_class& val, unsigned width) {
+    if (mpz_fits_slong_p(val.get_mpz_t())) {
+        return llvm::APInt(width, static_cast<uint64_t>(mpz_get_si(val.get_mpz_t())), true);
+    }
+
+    auto numWords = (mpz_sizeinbase(val.get_mpz_t(), 2) + 63) / 64;
+    std::vector<uint64_t> words(numWords, 0);
+    size_t count = 0;
+    mpz_export(words.data(), &count, -1, sizeof(uint64_t), 0, 0, val.get_mpz_t());
+
+    auto bitsize = std::max<unsigned>(width, numWords * 64);
+    llvm::APInt result(bitsize, llvm::ArrayRef<uint64_t>(words.data(), count));
+    if (sgn(val) < 0) result = -result;
+    return bitsize > width ? result.trunc(width) : result;
+}
+
 bool llvm_types_eq(const llvm::Type* lhv, const llvm::Type* rhv) {
     if (lhv == rhv) return true;
     if (lhv->getTypeID() != rhv->getTypeID()) return false;
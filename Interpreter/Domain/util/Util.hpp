@@ -5,6 +5,8 @@
 #ifndef BOREALIS_UTILS_HPP
 #define BOREALIS_UTILS_HPP
 
+#include <gmpxx.h>
+
 #include <llvm/ADT/APInt.h>
 #include <llvm/ADT/APSInt.h>
 #include <llvm/ADT/APFloat.h>
@@ -43,6 +45,11 @@ llvm::APFloat normalizeFloat(const llvm::APFloat& n);
 std::string toString(const llvm::APFloat& val);
 std::string toString(const llvm::APInt& val, bool isSigned = false);
 
+/// Direct word-level conversions between llvm::APInt and GMP, without going through strings
+mpz_class toGMP(const llvm::APInt& val, bool isSigned);
+/// Result is truncated to @width bits, same as for llvm::APInt construction from integer
+llvm::APInt fromGMP(const mpz_class& val, unsigned width);
+
 ///////////////////////////////////////////////////////////////
 /// templates
 ///////////////////////////////////////////////////////////////
@@ -15,15 +15,15 @@ namespace borealis {
 namespace absint {
 namespace ir {
 
-BasicBlock::BasicBlock(const llvm::BasicBlock* bb, SlotTracker* tracker, VariableFactory* factory)
+BasicBlock::BasicBlock(const llvm::BasicBlock* bb, SlotTracker* tracker, VariableFactory* factory, PacksPtr packs)
         : instance_(bb),
           tracker_(tracker),
           factory_(factory),
           inputChanged_(false),
           atFixpoint_(false),
           visited_(false) {
-    inputState_ = std::make_shared<State>(factory_);
-    outputState_ = std::make_shared<State>(factory_);
+    inputState_ = std::make_shared<State>(factory_, packs);
+    outputState_ = std::make_shared<State>(factory_, packs);
 }
 
 const llvm::BasicBlock* BasicBlock::getInstance() const {
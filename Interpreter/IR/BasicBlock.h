@@ -10,6 +10,7 @@
 #include <llvm/IR/BasicBlock.h>
 
 #include "Interpreter/Domain/AbstractDomain.hpp"
+#include "Interpreter/IR/DomainStorage.hpp"
 #include "Util/slottracker.h"
 
 #include "Util/macros.h"
@@ -21,13 +22,12 @@ class VariableFactory;
 
 namespace ir {
 
-class DomainStorage;
-
 class BasicBlock {
 public:
 
     using State = DomainStorage;
     using StatePtr = std::shared_ptr<State>;
+    using PacksPtr = DomainStorage::PacksT::Ptr;
 
 private:
 
@@ -45,7 +45,7 @@ private:
 
 public:
 
-    BasicBlock(const llvm::BasicBlock* bb, SlotTracker* tracker, VariableFactory* factory);
+    BasicBlock(const llvm::BasicBlock* bb, SlotTracker* tracker, VariableFactory* factory, PacksPtr packs = nullptr);
     BasicBlock(const BasicBlock&) = default;
     BasicBlock(BasicBlock&&) = default;
 
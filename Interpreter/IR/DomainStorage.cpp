@@ -22,18 +22,6 @@ namespace ir {
 
 namespace impl_ {
 
-struct ValueEquals {
-    bool operator()(const llvm::Value* lhv, const llvm::Value* rhv) const {
-        return lhv == rhv;
-    }
-};
-
-struct ValueHash {
-    size_t operator()(const llvm::Value* lhv) const {
-        return util::hash::defaultHasher()(lhv);
-    }
-};
-
 template <typename IntervalT>
 class IntervalDomainImpl : public IntervalDomain<IntervalT, const llvm::Value*, ValueHash, ValueEquals> {
 public:
@@ -131,8 +119,10 @@ public:
     using Ptr = AbstractDomain::Ptr;
     using ConstPtr = AbstractDomain::ConstPtr;
     using Variable = const llvm::Value*;
-    using DOctagon = DoubleOctagon<N1, N2, const llvm::Value*, ValueHash, ValueEquals>;
-    using OctagonMap = std::unordered_map<size_t, Ptr>;
+    using Base = OctagonDomain<N1, N2, const llvm::Value*, ValueHash, ValueEquals>;
+    using DOctagon = typename Base::DOctagon;
+    using OctagonMap = typename Base::OctagonMap;
+    using PacksT = typename Base::PacksT;
     using Self = OctagonDomainImpl<N1, N2>;
 
 protected:
@@ -176,7 +166,7 @@ protected:
 
 public:
 
-    explicit OctagonDomainImpl(VariableFactory* vf) : OctagonDomain<N1, N2, const llvm::Value*, ValueHash, ValueEquals>(), vf_(vf) {}
+    OctagonDomainImpl(VariableFactory* vf, typename PacksT::Ptr packs) : Base(packs), vf_(vf) {}
     OctagonDomainImpl(const OctagonDomainImpl&) = default;
     OctagonDomainImpl(OctagonDomainImpl&&) = default;
     OctagonDomainImpl& operator=(const OctagonDomainImpl& other) = default;
@@ -201,8 +191,7 @@ public:
             return vf_->get(constant);
 
         } else {
-            auto bitsize = unwrapTypeSize(x);
-            auto* octagon = this->unwrapOctagon(bitsize);
+            auto* octagon = this->unwrapOctagon(x);
 
             return octagon->get(x);
         }
@@ -215,12 +204,16 @@ public:
     }
 
     void applyTo(llvm::ArithType op, Variable x, Variable y, Variable z) override {
-        auto bitsize = this->unwrapTypeSize(x);
-        auto* octagon = this->unwrapOctagon(bitsize);
-
         auto&& yConst = getConstant(y);
         auto&& zConst = getConstant(z);
 
+        if ((not yConst && not this->inSamePack(x, y)) || (not zConst && not this->inSamePack(x, z))) {
+            this->set(x, this->get(y)->apply(op, this->get(z)));
+            return;
+        }
+
+        auto* octagon = this->unwrapOctagon(x);
+
         if (yConst && zConst) {
             octagon->applyTo(op, x, yConst.getUnsafe(), zConst.getUnsafe());
         } else if (yConst) {
@@ -233,12 +226,15 @@ public:
     }
 
     Ptr applyTo(llvm::ConditionType op, Variable x, Variable y) override {
-        auto bitsize = this->unwrapTypeSize(x);
-        auto* octagon = this->unwrapOctagon(bitsize);
-
         auto&& xConst = getConstant(x);
         auto&& yConst = getConstant(y);
 
+        if (not xConst && not yConst && not this->inSamePack(x, y)) {
+            return this->get(x)->apply(op, this->get(y));
+        }
+
+        auto* octagon = this->unwrapOctagon(xConst ? y : x);
+
         if (xConst && yConst) {
             return octagon->applyTo(op, xConst.getUnsafe(), yConst.getUnsafe());
         } else if (xConst) {
@@ -251,12 +247,16 @@ public:
     }
 
     void addConstraint(llvm::ConditionType op, Variable x, Variable y) override {
-        auto bitsize = this->unwrapTypeSize(x);
-        auto* octagon = this->unwrapOctagon(bitsize);
-
         auto&& xConst = getConstant(x);
         auto&& yConst = getConstant(y);
 
+        // relations between variables from different packs are not tracked
+        if (not xConst && not yConst && not this->inSamePack(x, y)) {
+            return;
+        }
+
+        auto* octagon = this->unwrapOctagon(xConst ? y : x);
+
         if (xConst && yConst) {
             return;
         } else if (xConst) {
@@ -410,7 +410,7 @@ public:
 
 static config::StringConfigEntry numericalDomain("absint", "numeric");
 
-inline AbstractDomain::Ptr initNumericalDomain(VariableFactory* vf) {
+inline AbstractDomain::Ptr initNumericalDomain(VariableFactory* vf, DomainStorage::PacksT::Ptr packs) {
     auto&& numericalDomainName = numericalDomain.get("interval");
 
     using SIntT = typename DomainStorage::SIntT;
@@ -419,7 +419,7 @@ inline AbstractDomain::Ptr initNumericalDomain(VariableFactory* vf) {
     if (numericalDomainName == "interval") {
         return std::make_shared<impl_::IntervalDomainImpl<DoubleInterval<SIntT, UIntT>>>(vf);
     } else if (numericalDomainName == "octagon") {
-        return std::make_shared<impl_::OctagonDomainImpl<SIntT, UIntT>>(vf);
+        return std::make_shared<impl_::OctagonDomainImpl<SIntT, UIntT>>(vf, packs);
     } else {
         UNREACHABLE("Unknown numerical domain name");
     }
@@ -455,11 +455,11 @@ DomainStorage::AggregateDomainT* DomainStorage::unwrapStruct() const {
     return structure;
 }
 
-DomainStorage::DomainStorage(VariableFactory* vf) :
+DomainStorage::DomainStorage(VariableFactory* vf, PacksT::Ptr packs) :
         ObjectLevelLogging("domain"),
         vf_(vf),
         bools_(std::make_shared<impl_::IntervalDomainImpl<Interval<UIntT>>>(vf_)),
-        ints_(initNumericalDomain(vf_)),
+        ints_(initNumericalDomain(vf_, packs)),
         floats_(std::make_shared<impl_::IntervalDomainImpl<Interval<Float>>>(vf_)),
         memory_(std::make_shared<impl_::PointsToDomainImpl<MachineIntT>>(vf_)),
         structs_(std::make_shared<impl_::AggregateDomainImpl<StructDomain<MachineIntT>>>(vf_)) {}
@@ -8,6 +8,8 @@
 #include "Interpreter/Domain/AbstractDomain.hpp"
 #include "Interpreter/Domain/AbstractFactory.hpp"
 #include "Interpreter/Domain/Numerical/Number.hpp"
+#include "Interpreter/Domain/Numerical/Apron/VariablePacks.hpp"
+#include "Util/hash.hpp"
 
 namespace borealis {
 namespace absint {
@@ -25,6 +27,22 @@ class Aggregate;
 
 namespace ir {
 
+namespace impl_ {
+
+struct ValueEquals {
+    bool operator()(const llvm::Value* lhv, const llvm::Value* rhv) const {
+        return lhv == rhv;
+    }
+};
+
+struct ValueHash {
+    size_t operator()(const llvm::Value* lhv) const {
+        return util::hash::defaultHasher()(lhv);
+    }
+};
+
+} // namespace impl_
+
 class DomainStorage
         : public logging::ObjectLevelLogging<DomainStorage>, public std::enable_shared_from_this<DomainStorage> {
 public:
@@ -39,6 +57,7 @@ public:
     using NumericalDomainT = NumericalDomain<Variable>;
     using MemoryDomainT = MemoryDomain<MachineIntT, Variable>;
     using AggregateDomainT = Aggregate<Variable>;
+    using PacksT = VariablePacks<Variable, impl_::ValueHash, impl_::ValueEquals>;
 
 protected:
 
@@ -50,7 +69,8 @@ protected:
 
 public:
 
-    explicit DomainStorage(VariableFactory* vf);
+    /// @packs are used by relational numerical domains, nullptr means no packing
+    explicit DomainStorage(VariableFactory* vf, PacksT::Ptr packs = nullptr);
     DomainStorage(const DomainStorage&) = default;
     DomainStorage(DomainStorage&&) = default;
     DomainStorage& operator=(const DomainStorage&) = default;
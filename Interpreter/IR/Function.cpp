@@ -2,6 +2,7 @@
 // Created by abdullin on 2/10/17.
 //
 
+#include "Config/config.h"
 #include "DomainStorage.hpp"
 #include "Interpreter/Domain/VariableFactory.hpp"
 #include "Function.h"
@@ -14,12 +15,60 @@ namespace borealis {
 namespace absint {
 namespace ir {
 
+static config::StringConfigEntry numericalDomain("absint", "numeric");
+static config::IntConfigEntry octagonPackSize("absint", "octagon-pack-size");
+
+namespace impl_ {
+
+static bool isPackable(const llvm::Value* value) {
+    // bools are stored in a separate domain, constants are not variables at all
+    return value->getType()->isIntegerTy() &&
+           not value->getType()->isIntegerTy(1) &&
+           not llvm::isa<llvm::Constant>(value);
+}
+
+/// Variables are packed together if they are used in the same arithmetic operation,
+/// comparison, phi or select. Pack size is limited, so relations that do not fit are lost
+static Function::PacksPtr buildVariablePacks(const llvm::Function* function) {
+    auto packSize = octagonPackSize.get(0);
+    if (numericalDomain.get("interval") != "octagon" || packSize <= 0) return nullptr;
+
+    auto&& packs = std::make_shared<DomainStorage::PacksT>(packSize);
+    for (auto&& arg : function->args()) {
+        if (isPackable(&arg)) packs->add(&arg);
+    }
+
+    for (auto&& inst : util::viewContainer(*function)
+            .flatten()
+            .map(ops::take_pointer)) {
+        std::vector<const llvm::Value*> related;
+        if (isPackable(inst)) related.push_back(inst);
+
+        if (llvm::isa<llvm::BinaryOperator>(inst) ||
+            llvm::isa<llvm::CmpInst>(inst) ||
+            llvm::isa<llvm::PHINode>(inst) ||
+            llvm::isa<llvm::SelectInst>(inst)) {
+            for (auto&& op : inst->operand_values()) {
+                if (isPackable(op)) related.push_back(op);
+            }
+        }
+
+        packs->relate(related);
+    }
+
+    packs->finalize();
+    return packs;
+}
+
+} // namespace impl_
+
 Function::Function(const llvm::Function* function, VariableFactory* factory, SlotTracker* st)
         : instance_(function),
           tracker_(st),
-          factory_(factory) {
-    inputState_ = std::make_shared<State>(factory_);
-    outputState_ = std::make_shared<State>(factory_);
+          factory_(factory),
+          packs_(impl_::buildVariablePacks(function)) {
+    inputState_ = std::make_shared<State>(factory_, packs_);
+    outputState_ = std::make_shared<State>(factory_, packs_);
     for (auto i = 0U; i < instance_->getArgumentList().size(); ++i) arguments_.emplace_back(nullptr);
 
     // find all global variables, that this function depends on
@@ -32,7 +81,7 @@ Function::Function(const llvm::Function* function, VariableFactory* factory, Slo
     }
 
     for (auto&& block : util::viewContainer(*instance_)) {
-        blocks_.insert( {&block, std::move(BasicBlock{&block, tracker_, factory_}) });
+        blocks_.insert( {&block, std::move(BasicBlock{&block, tracker_, factory_, packs_}) });
     }
 
 }
@@ -49,6 +98,10 @@ const Function::BlockMap& Function::getBasicBlocks() const {
     return blocks_;
 }
 
+Function::PacksPtr Function::getVariablePacks() const {
+    return packs_;
+}
+
 AbstractDomain::Ptr Function::getReturnValue() const {
     return (returnValue_ != nullptr) ? outputState_->get(returnValue_) : nullptr;
 }
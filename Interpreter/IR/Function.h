@@ -28,6 +28,7 @@ public:
     using BlockMap = std::unordered_map<const llvm::BasicBlock*, BasicBlock>;
     using State = BasicBlock::State;
     using StatePtr = BasicBlock::StatePtr;
+    using PacksPtr = BasicBlock::PacksPtr;
 
 private:
 
@@ -36,6 +37,7 @@ private:
     mutable SlotTracker* tracker_;
     VariableFactory* factory_;
     std::vector<AbstractDomain::Ptr> arguments_;
+    PacksPtr packs_;
     BlockMap blocks_;
     StatePtr inputState_;
     StatePtr outputState_;
@@ -50,6 +52,8 @@ public:
     const llvm::Function* getInstance() const;
     const std::vector<AbstractDomain::Ptr>& getArguments() const;
     const BlockMap& getBasicBlocks() const;
+    /// Variable packs for relational domains, nullptr if packing is disabled
+    PacksPtr getVariablePacks() const;
     AbstractDomain::Ptr getReturnValue() const;
 
     AbstractDomain::Ptr getDomainFor(const llvm::Value* value, const llvm::BasicBlock* location);
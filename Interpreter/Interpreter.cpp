@@ -16,12 +16,49 @@ namespace absint {
 namespace ir {
 
 static config::BoolConfigEntry printModule("absint", "print-module");
+static config::IntConfigEntry maxSummaries("absint", "max-summaries");
+
+namespace {
+
+/// Object, that is accessed through @ptr, without casts and offsets
+const llvm::Value* accessedObject(const llvm::Value* ptr) {
+    while (true) {
+        if (auto&& gep = llvm::dyn_cast<llvm::GEPOperator>(ptr)) ptr = gep->getPointerOperand();
+        else if (auto&& cast = llvm::dyn_cast<llvm::BitCastOperator>(ptr)) ptr = cast->getOperand(0);
+        else return ptr;
+    }
+}
+
+/// Checks that @ptr is used by @user only to load or store the pointed memory
+bool isDirectAccess(const llvm::User* user, const llvm::Value* ptr) {
+    if (llvm::isa<llvm::LoadInst>(user)) return true;
+    if (auto&& store = llvm::dyn_cast<llvm::StoreInst>(user)) return store->getPointerOperand() == ptr;
+    if (llvm::isa<llvm::GEPOperator>(user) || llvm::isa<llvm::BitCastOperator>(user)) {
+        for (auto&& it : user->users()) {
+            if (not isDirectAccess(it, user)) return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace
 
 Interpreter::Interpreter(const llvm::Module* module, FuncInfoProvider* FIP, SlotTrackerPass* st, CallGraphSlicer* cgs)
-        : ObjectLevelLogging("ir-interpreter"), module_(module, st), TF_(TypeFactory::get()), FIP_(FIP), ST_(st), CGS_(cgs) {
+        : ObjectLevelLogging("ir-interpreter"), module_(module, st), TF_(TypeFactory::get()), FIP_(FIP), ST_(st), CGS_(cgs),
+          context_(nullptr), useSummaries_(false) {
     std::unordered_set<const llvm::Value*> globals;
     for (auto&& it : module->globals()) globals.insert(&it);
     module_.initGlobals(globals);
+
+    for (auto&& it : module->globals()) {
+        for (auto&& user : it.users()) {
+            if (not isDirectAccess(user, &it)) {
+                escapedGlobals_.insert(&it);
+                break;
+            }
+        }
+    }
 }
 
 void Interpreter::run() {
@@ -113,6 +150,46 @@ void Interpreter::interpretFunction(Function::Ptr function, const std::vector<Ab
                &stack_.top();
 }
 
+void Interpreter::interpretSCC(const std::vector<const llvm::Function*>& scc) {
+    useSummaries_ = true;
+    currentSCC_ = std::unordered_set<const llvm::Function*>(scc.begin(), scc.end());
+
+    for (auto&& it : scc) {
+        if (it->isDeclaration()) continue;
+
+        std::vector<AbstractDomain::Ptr> args;
+        for (auto&& arg : it->getArgumentList()) {
+            args.emplace_back(module_.variableFactory()->top(arg.getType()));
+        }
+        interpretFunction(module_.get(it), args);
+    }
+
+    // summaries are created after the whole SCC is analyzed,
+    // calls inside of the SCC are interpreted on demand
+    auto&& limit = static_cast<size_t>(maxSummaries.get(100000));
+    std::vector<const llvm::Function*> summarized;
+    for (auto&& it : scc) {
+        if (it->isDeclaration()) continue;
+        if (summaries_.size() >= limit) {
+            warns() << "Summary limit exceeded, " << it->getName() << " calls will be considered unknown" << endl;
+            continue;
+        }
+        summaries_.insert({ it, makeSummary(module_.get(it)) });
+        summarized.push_back(it);
+    }
+    // every function of the SCC may call any other one, so they may write the same globals
+    std::unordered_set<const llvm::GlobalVariable*> sccGlobals;
+    for (auto&& it : summarized) {
+        auto&& globals = summaries_.at(it).globals;
+        sccGlobals.insert(globals.begin(), globals.end());
+    }
+    for (auto&& it : summarized) {
+        auto&& summary = summaries_.at(it);
+        if (summary.writesMemory) summary.globals = sccGlobals;
+    }
+    currentSCC_.clear();
+}
+
 /////////////////////////////////////////////////////////////////////
 /// Visitors
 /////////////////////////////////////////////////////////////////////
@@ -406,6 +483,11 @@ AbstractDomain::Ptr Interpreter::handleFunctionCall(
         return context_->state->get(result);
     } else if (function->isDeclaration()) {
         return handleDeclaration(function, result, args);
+    } else if (auto&& summary = util::at(summaries_, function)) {
+        return applySummary(summary.getUnsafe(), args);
+    } else if (useSummaries_ && not util::contains(currentSCC_, function)) {
+        // callee is not summarized because of the limit, so we know nothing about it
+        return handleDeclaration(function, result, args);
     } else {
         auto func = module_.get(function);
         if (callStack_.count(func))
@@ -450,6 +532,57 @@ AbstractDomain::Ptr Interpreter::handleDeclaration(const llvm::Function* functio
     return module_.variableFactory()->top(function->getReturnType());
 }
 
+AbstractDomain::Ptr Interpreter::applySummary(const Summary& summary,
+                                              const std::vector<std::pair<const llvm::Value*, AbstractDomain::Ptr>>& args) {
+    for (auto j = 0U; j < args.size(); ++j) {
+        auto arg = args[j].first;
+        if (not arg->getType()->isPointerTy()) continue;
+
+        auto clobbered = j < summary.clobbers.size() ? summary.clobbers[j] : summary.writesMemory;
+        if (clobbered) context_->state->get(arg)->setTop();
+    }
+    // globals are shared by all the functions, so values written by callee are lost
+    for (auto&& global : summary.globals) {
+        context_->state->get(global)->setTop();
+    }
+    // return value of the summary may be changed by the caller
+    return summary.retval ? summary.retval->clone() : nullptr;
+}
+
+Interpreter::Summary Interpreter::makeSummary(Function::Ptr function) const {
+    auto&& instance = function->getInstance();
+
+    Summary summary;
+    summary.retval = function->getReturnValue();
+    summary.writesMemory = not instance->onlyReadsMemory();
+    for (auto&& arg : instance->getArgumentList()) {
+        summary.clobbers.emplace_back(arg.getType()->isPointerTy() && summary.writesMemory && not arg.onlyReadsMemory());
+    }
+    if (not summary.writesMemory) return summary;
+
+    auto writesUnknown = false;
+    for (auto&& inst : util::viewContainer(*instance).flatten().map(ops::take_pointer)) {
+        if (auto&& store = llvm::dyn_cast<llvm::StoreInst>(inst)) {
+            auto&& object = accessedObject(store->getPointerOperand());
+            if (auto&& global = llvm::dyn_cast<llvm::GlobalVariable>(object)) summary.globals.insert(global);
+            // arguments may point to globals as well
+            else if (not llvm::isa<llvm::AllocaInst>(object)) writesUnknown = true;
+
+        } else if (auto&& call = llvm::dyn_cast<llvm::CallInst>(inst)) {
+            // calls inside of the SCC are accounted in interpretSCC
+            auto&& callee = call->getCalledFunction();
+            if (not callee) continue;
+            if (auto&& calleeSummary = util::at(summaries_, callee)) {
+                auto&& globals = calleeSummary.getUnsafe().globals;
+                summary.globals.insert(globals.begin(), globals.end());
+            }
+        }
+    }
+    // memory written through unknown pointer may be any of escaped globals
+    if (writesUnknown) summary.globals.insert(escapedGlobals_.begin(), escapedGlobals_.end());
+    return summary;
+}
+
 }   /* namespace ir */
 }   /* namespace absint */
 }   /* namespace borealis */
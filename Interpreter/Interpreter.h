@@ -32,6 +32,9 @@ public:
     Module& getModule();
 
     void interpretFunction(Function::Ptr function, const std::vector<AbstractDomain::Ptr>& args);
+    /// Interprets functions of a call graph SCC with unknown arguments and summarizes them.
+    /// All the callees outside of the SCC should be summarized before
+    void interpretSCC(const std::vector<const llvm::Function*>& scc);
 
     /// llvm instructions visitors
     void visitInstruction(llvm::Instruction& i);
@@ -75,6 +78,14 @@ private:
         std::unordered_set<const llvm::Value*> stores; // stores, visited in current context
     };
 
+    /// Context-insensitive effect of a function, used instead of interpretation at call sites
+    struct Summary {
+        AbstractDomain::Ptr retval;
+        std::vector<bool> clobbers; // formal pointer arguments that function may write through
+        bool writesMemory; // used for variadic arguments
+        std::unordered_set<const llvm::GlobalVariable*> globals; // globals that function may write to
+    };
+
     /// Util functions
     void gepOperator(const llvm::GEPOperator& gep);
     void addSuccessors(const std::vector<BasicBlock*>& successors);
@@ -84,6 +95,9 @@ private:
     AbstractDomain::Ptr handleDeclaration(const llvm::Function* function,
             const llvm::Value* result,
             const std::vector<std::pair<const llvm::Value*, AbstractDomain::Ptr>>& args);
+    AbstractDomain::Ptr applySummary(const Summary& summary,
+            const std::vector<std::pair<const llvm::Value*, AbstractDomain::Ptr>>& args);
+    Summary makeSummary(Function::Ptr function) const;
 
     Module module_;
     TypeFactory::Ptr TF_;
@@ -94,6 +108,12 @@ private:
     Context* context_;  // active context
     std::stack<Context> stack_; // stack of contexts of interpreter
     std::unordered_set<Function::Ptr, FunctionHash, FunctionEquals> callStack_;
+
+    bool useSummaries_;
+    std::unordered_set<const llvm::Function*> currentSCC_;
+    std::unordered_map<const llvm::Function*, Summary> summaries_;
+    // globals, which address is used not only for loads and stores, may be written through any pointer
+    std::unordered_set<const llvm::GlobalVariable*> escapedGlobals_;
 };
 
 }   /* namespace ir */
@@ -196,7 +196,7 @@ public:
     using ConstPtr = AbstractDomain::ConstPtr;
     using Variable = Term::Ptr;
     using DOctagon = DoubleOctagon<N1, N2, Term::Ptr, TermHash, TermEqualsWType>;
-    using OctagonMap = std::unordered_map<size_t, Ptr>;
+    using OctagonMap = typename OctagonDomain<N1, N2, Term::Ptr, TermHash, TermEqualsWType>::OctagonMap;
     using Self = OctagonDomainImpl<N1, N2>;
     using ParentT = NumericalDomain<Variable>;
 
@@ -276,8 +276,7 @@ public:
             return constant;
 
         } else {
-            auto bitsize = unwrapTypeSize(x);
-            auto* octagon = this->unwrapOctagon(bitsize);
+            auto* octagon = this->unwrapOctagon(x);
 
             return octagon->get(x);
         }
@@ -290,8 +289,7 @@ public:
     }
 
     void applyTo(llvm::ArithType op, Variable x, Variable y, Variable z) override {
-        auto bitsize = this->unwrapTypeSize(x);
-        auto* octagon = this->unwrapOctagon(bitsize);
+        auto* octagon = this->unwrapOctagon(x);
 
         auto&& yConst = getConstant(y);
         auto&& zConst = getConstant(z);
@@ -308,8 +306,7 @@ public:
     }
 
     Ptr applyTo(llvm::ConditionType op, Variable x, Variable y) override {
-        auto bitsize = this->unwrapTypeSize(x);
-        auto* octagon = this->unwrapOctagon(bitsize);
+        auto* octagon = this->unwrapOctagon(x);
 
         auto&& xConst = getConstant(x);
         auto&& yConst = getConstant(y);
@@ -326,8 +323,7 @@ public:
     }
 
     void addConstraint(llvm::ConditionType op, Variable x, Variable y) override {
-        auto bitsize = this->unwrapTypeSize(x);
-        auto* octagon = this->unwrapOctagon(bitsize);
+        auto* octagon = this->unwrapOctagon(x);
 
         auto&& xConst = getConstant(x);
         auto&& yConst = getConstant(y);
@@ -31,14 +31,8 @@ namespace ps {
 struct TermEqualsWType {
     bool operator()(Term::Ptr lhv, Term::Ptr rhv) const noexcept {
         // This is generally fucked up
-        if (lhv->equals(rhv.get())) {
-            if (lhv->getType() == rhv->getType()) return true;
-            auto&& t1 = llvm::dyn_cast<type::Integer>(lhv->getType().get());
-            auto&& t2 = llvm::dyn_cast<type::Integer>(rhv->getType().get());
-            if (t1 && t2) return t1->getBitsize() == t2->getBitsize();
-            else return false;
-        }
-        return false;
+        // types are interned, and integers of the same bitsize have the same shape regardless of signedness
+        return lhv->equals(rhv.get()) && lhv->getType()->getShapeId() == rhv->getType()->getShapeId();
     }
 };
 
@@ -0,0 +1,374 @@
+/*
+ * async_appender.cpp
+ */
+
+#include <log4cpp/Category.hh>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include "Logging/async_appender.hpp"
+
+namespace borealis {
+namespace logging {
+
+namespace {
+
+std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<std::unique_ptr<AsyncAppender>>& registry() {
+    static std::vector<std::unique_ptr<AsyncAppender>> appenders;
+    return appenders;
+}
+
+size_t roundUp(size_t capacity) {
+    size_t res = 2;
+    while (res < capacity) res <<= 1;
+    return res;
+}
+
+} /* namespace */
+
+AsyncAppender::AsyncAppender(log4cpp::Appender* target, bool owns, size_t capacity):
+        log4cpp::AppenderSkeleton(target->getName() + ".async"),
+        target(target), owned(owns ? target : nullptr), cells(roundUp(capacity)), mask(cells.size() - 1),
+        head(0), tail(0), stopping(false), frozen(false), detached(false) {
+    for (auto i = 0U; i < cells.size(); ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    writer = std::thread([this]() { write(); });
+}
+
+AsyncAppender::~AsyncAppender() {
+    close();
+}
+
+// bounded MPMC queue by D. Vyukov: every cell carries a sequence number
+// telling whether it is ready to be written to or read from at a given position
+bool AsyncAppender::push(std::unique_ptr<log4cpp::LoggingEvent>& event) {
+    auto pos = tail.load(std::memory_order_relaxed);
+    while (true) {
+        auto&& cell = cells[pos & mask];
+        auto seq = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.event = std::move(event);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+std::unique_ptr<log4cpp::LoggingEvent> AsyncAppender::pop() {
+    auto pos = head.load(std::memory_order_relaxed);
+    while (true) {
+        auto&& cell = cells[pos & mask];
+        auto seq = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                auto res = std::move(cell.event);
+                cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                return res;
+            }
+        } else if (diff < 0) {
+            return nullptr;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncAppender::write() {
+    using namespace std::chrono_literals;
+
+    while (not frozen.load()) {
+        if (auto&& event = pop()) {
+            target->doAppend(*event);
+        } else if (stopping.load()) {
+            return;
+        } else {
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+}
+
+void AsyncAppender::stop() {
+    if (not writer.joinable()) return;
+    stopping.store(true);
+    writer.join();
+    stopping.store(false);
+}
+
+void AsyncAppender::drain() {
+    while (auto&& event = pop()) {
+        target->doAppend(*event);
+    }
+}
+
+void AsyncAppender::_append(const log4cpp::LoggingEvent& event) {
+    if (detached.load(std::memory_order_relaxed)) {
+        target->doAppend(event);
+        return;
+    }
+
+    auto&& copy = std::make_unique<log4cpp::LoggingEvent>(event);
+    while (not push(copy)) std::this_thread::yield();
+}
+
+void AsyncAppender::flush() {
+    // the control mutex may have been held by another thread of the parent
+    if (detached.load()) return;
+
+    std::lock_guard<std::mutex> lock(control);
+    // the writer is stopped first, so that nobody else touches the target while we drain
+    auto running = writer.joinable();
+    stop();
+    drain();
+    if (running) writer = std::thread([this]() { write(); });
+}
+
+namespace {
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        auto written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+void writeAll(int fd, const std::string& str) {
+    writeAll(fd, str.data(), str.size());
+}
+
+} /* namespace */
+
+void AsyncAppender::dump(int fd) {
+    // the process is going down, the writer is not let to free the events we are reading
+    frozen.store(true);
+
+    auto end = tail.load(std::memory_order_acquire);
+    for (auto pos = head.load(std::memory_order_acquire); pos != end; ++pos) {
+        auto&& cell = cells[pos & mask];
+        // taken already or not written in full yet
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) continue;
+        auto* event = cell.event.get();
+        if (not event) continue;
+
+        writeAll(fd, event->categoryName);
+        writeAll(fd, ": ", 2);
+        writeAll(fd, event->message);
+        writeAll(fd, "\n", 1);
+    }
+}
+
+void AsyncAppender::detach() {
+    while (pop());
+    detached.store(true);
+}
+
+bool AsyncAppender::reopen() {
+    if (detached.load()) return target->reopen();
+
+    std::lock_guard<std::mutex> lock(control);
+    auto running = writer.joinable();
+    stop();
+    drain();
+    auto res = target->reopen();
+    if (running) writer = std::thread([this]() { write(); });
+    return res;
+}
+
+void AsyncAppender::close() {
+    // in a forked child the thread object was copied from the parent, there is nothing to join
+    if (detached.load()) return;
+
+    std::lock_guard<std::mutex> lock(control);
+    stop();
+    drain();
+    // whatever is logged after closing is written right away
+    detached.store(true);
+}
+
+bool AsyncAppender::requiresLayout() const {
+    return false;
+}
+
+void AsyncAppender::setLayout(log4cpp::Layout* layout) {
+    target->setLayout(layout);
+}
+
+namespace {
+
+const std::vector<int>& crashSignals() {
+    // the same ones backward-cpp handles in the drivers
+    static std::vector<int> signals{ SIGABRT, SIGSEGV, SIGILL, SIGINT, SIGTRAP };
+    return signals;
+}
+
+std::map<int, struct sigaction>& previousHandlers() {
+    static std::map<int, struct sigaction> handlers;
+    return handlers;
+}
+
+void onCrash(int signal, siginfo_t* info, void* context) {
+    dumpAsyncAppenders();
+
+    auto&& previous = previousHandlers()[signal];
+    sigaction(signal, &previous, nullptr);
+    if (previous.sa_flags & SA_SIGINFO) {
+        previous.sa_sigaction(signal, info, context);
+    } else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+        previous.sa_handler(signal);
+    } else {
+        raise(signal);
+    }
+}
+
+void installCrashHandlers() {
+    static bool installed = false;
+    if (installed) return;
+    installed = true;
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = onCrash;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_NODEFER | SA_RESETHAND;
+    sigfillset(&action.sa_mask);
+
+    for (auto&& signal : crashSignals()) {
+        sigaction(signal, &action, &previousHandlers()[signal]);
+    }
+}
+
+std::string trim(const std::string& str) {
+    auto begin = str.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    auto end = str.find_last_not_of(" \t\r");
+    return str.substr(begin, end - begin + 1);
+}
+
+// a category gives up an appender it owns only by deleting it,
+// but its derived classes can reach the ownership flag
+struct CategoryOwnership: log4cpp::Category {
+    using OwnsMethod = bool (log4cpp::Category::*)(log4cpp::Appender*, OwnsAppenderMap::iterator&);
+
+    // makes @category stop owning @appender, returns whether it did own it
+    static bool disown(log4cpp::Category& category, log4cpp::Appender* appender) {
+        auto owns = static_cast<OwnsMethod>(&CategoryOwnership::ownsAppender);
+        OwnsAppenderMap::iterator it;
+        if (not (category.*owns)(appender, it)) return false;
+        it->second = false;
+        return true;
+    }
+};
+
+} /* namespace */
+
+void configureAsyncAppenders(const std::string& filename) {
+    static const std::string prefix = "appender.";
+    static const std::string asyncSuffix = ".async";
+    static const std::string capacitySuffix = ".async.capacity";
+
+    std::map<std::string, bool> async;
+    std::map<std::string, size_t> capacities;
+
+    std::ifstream input(filename);
+    for (std::string line; std::getline(input, line);) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        auto eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        auto key = trim(line.substr(0, eq));
+        auto value = trim(line.substr(eq + 1));
+        if (key.compare(0, prefix.size(), prefix) != 0) continue;
+
+        auto&& endsWith = [&](const std::string& suffix) {
+            return key.size() > prefix.size() + suffix.size()
+                && key.compare(key.size() - suffix.size(), suffix.size(), suffix) == 0;
+        };
+        if (endsWith(capacitySuffix)) {
+            auto name = key.substr(prefix.size(), key.size() - prefix.size() - capacitySuffix.size());
+            capacities[name] = std::stoul(value);
+        } else if (endsWith(asyncSuffix)) {
+            auto name = key.substr(prefix.size(), key.size() - prefix.size() - asyncSuffix.size());
+            async[name] = (value == "true" || value == "on");
+        }
+    }
+
+    std::unique_ptr<std::vector<log4cpp::Category*>> categories{ log4cpp::Category::getCurrentCategories() };
+
+    std::lock_guard<std::mutex> lock(registryMutex());
+    for (auto&& entry : async) {
+        if (not entry.second) continue;
+
+        auto* target = log4cpp::Appender::getAppender(entry.first);
+        if (not target) continue;
+
+        std::vector<log4cpp::Category*> users;
+        for (auto* category : *categories) {
+            if (category->getAppender(entry.first) == target) users.push_back(category);
+        }
+
+        // the wrapper takes the target over from the categories that owned it,
+        // so that removing it from them does not delete it
+        auto owns = false;
+        for (auto* category : users) {
+            owns |= CategoryOwnership::disown(*category, target);
+        }
+
+        auto capacity = capacities.count(entry.first) ? capacities[entry.first] : 1U << 16;
+        auto* wrapper = new AsyncAppender(target, owns, capacity);
+        registry().emplace_back(wrapper);
+
+        for (auto* category : users) {
+            category->removeAppender(target);
+            category->addAppender(*wrapper);
+        }
+    }
+
+    if (not registry().empty()) {
+        installCrashHandlers();
+        std::atexit([]() {
+            for (auto&& appender : registry()) appender->close();
+        });
+    }
+}
+
+void flushAsyncAppenders() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    for (auto&& appender : registry()) appender->flush();
+}
+
+void detachAsyncAppenders() {
+    // no locking here, the mutex may have been held by another thread of the parent
+    for (auto&& appender : registry()) appender->detach();
+}
+
+void dumpAsyncAppenders() {
+    // no locking here, this is called from signal handlers
+    for (auto&& appender : registry()) appender->dump(STDERR_FILENO);
+}
+
+} // namespace logging
+} // namespace borealis
@@ -0,0 +1,100 @@
+/*
+ * async_appender.hpp
+ */
+
+#ifndef LOGGING_ASYNC_APPENDER_HPP_
+#define LOGGING_ASYNC_APPENDER_HPP_
+
+#include <log4cpp/AppenderSkeleton.hh>
+#include <log4cpp/LoggingEvent.hh>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace borealis {
+namespace logging {
+
+// Appender that hands the events to a background writer thread.
+// The message text is already built by the logging thread, the layout
+// formatting and the I/O of the wrapped appender happen on the writer.
+// Events pass through a bounded lock-free queue, so the memory is bounded as well:
+// when the queue is full, the logging thread waits for the writer to catch up.
+// The wrapped appender is only ever used by one thread at a time: the writer,
+// or whoever stopped it to flush, reopen or close the appender
+class AsyncAppender: public log4cpp::AppenderSkeleton {
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        std::unique_ptr<log4cpp::LoggingEvent> event;
+    };
+
+    log4cpp::Appender* target;
+    // set when the wrapper took the target over from the categories that owned it
+    std::unique_ptr<log4cpp::Appender> owned;
+
+    std::vector<Cell> cells;
+    size_t mask;
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+
+    std::atomic<bool> stopping;
+    // set on a crash, the writer leaves the queue alone from then on
+    std::atomic<bool> frozen;
+    // set in a forked child, where the writer thread does not exist, and after close():
+    // the events are written by the logging thread right away
+    std::atomic<bool> detached;
+    // guards starting and stopping the writer
+    std::mutex control;
+    std::thread writer;
+
+    bool push(std::unique_ptr<log4cpp::LoggingEvent>& event);
+    std::unique_ptr<log4cpp::LoggingEvent> pop();
+    void write();
+    // both are called with @control held
+    void stop();
+    void drain();
+
+protected:
+
+    virtual void _append(const log4cpp::LoggingEvent& event) override;
+
+public:
+
+    // @capacity is rounded up to a power of two, @target is deleted with the wrapper if @owns
+    AsyncAppender(log4cpp::Appender* target, bool owns, size_t capacity);
+    virtual ~AsyncAppender();
+
+    // writes out everything queued so far, may be called from any thread, but not from a signal handler
+    void flush();
+    // async-signal-safe: writes the text of the queued messages to @fd with write(2),
+    // without formatting them or freeing anything, and stops the writer for good
+    void dump(int fd);
+    // called in a forked child: events queued by the parent are left to the parent's writer,
+    // new ones are written by the logging thread right away
+    void detach();
+
+    virtual bool reopen() override;
+    virtual void close() override;
+    virtual bool requiresLayout() const override;
+    virtual void setLayout(log4cpp::Layout* layout) override;
+};
+
+// wraps the appenders marked with `appender.<name>.async=true` in @filename,
+// `appender.<name>.async.capacity` sets the number of queued events
+void configureAsyncAppenders(const std::string& filename);
+// writes out everything queued in all the wrappers, see AsyncAppender::flush()
+void flushAsyncAppenders();
+// best effort, called on crashes before the backtrace is printed:
+// the messages still queued go to stderr as they are, without the layout
+void dumpAsyncAppenders();
+// call in a forked child before logging anything
+void detachAsyncAppenders();
+
+} // namespace logging
+} // namespace borealis
+
+#endif /* LOGGING_ASYNC_APPENDER_HPP_ */
@@ -11,6 +11,7 @@
 #include <log4cpp/PropertyConfigurator.hh>
 #include <z3/z3++.h>
 
+#include "Logging/async_appender.hpp"
 #include "Logging/logstream.hpp"
 
 inline static log4cpp::Priority::PriorityLevel mapPriorities(borealis::logging::PriorityLevel pli) {
@@ -66,6 +67,7 @@ stream_t logsFor(PriorityLevel lvl, const std::string& category) {
 
 void configureLoggingFacility(const std::string& filename) {
     PropertyConfigurator::configure(filename);
+    configureAsyncAppenders(filename);
 }
 
 void configureZ3Log(const std::string& filename) {
@@ -11,19 +11,25 @@
 
 #include "Interpreter/OneForOneInterpreter.h"
 #include "Logging/logger.hpp"
+#include "Passes/Checker/PendingVerdicts.h"
+#include "Passes/Checker/SolverScheduler.h"
+#include "Passes/Defect/DefectManager.h"
 #include "Passes/Defect/DefectManager/DefectInfo.h"
+#include "Passes/PredicateStateAnalysis/PredicateStateAnalysis.h"
 #include "SMT/MathSAT/Solver.h"
 #include "SMT/Z3/Solver.h"
 #include "SMT/Boolector/Solver.h"
 #include "SMT/STP/Solver.h"
 #include "SMT/CVC4/Solver.h"
 #include "SMT/Portfolio/Solver.h"
+#include "Statistics/statistics.h"
 #include "State/Transformer/GraphBuilder.h"
 #include "State/Transformer/MemorySpacer.h"
 #include "State/Transformer/PoorMem2Reg.h"
 #include "State/Transformer/StateSlicer.h"
 #include "State/Transformer/TermSizeCalculator.h"
 #include "State/Transformer/Normalizer.h"
+#include "Util/collections.hpp"
 #include "Util/time.hpp"
 
 #include "Util/macros.h"
@@ -54,12 +60,32 @@ public:
         return false;
     }
 
+    // abstract interpretation results are consulted before any state or query is built
+    bool discharged(const llvm::Value* operand) {
+        return discharged(operand, pass->DM->getDefect(defectType, I));
+    }
+    bool discharged(const llvm::Value* operand, const DefectInfo& di) {
+        static config::BoolConfigEntry prefilter("absint", "prefilter-queries");
+        static Statistic dischargedQueries("absint-prefilter",
+            Pass::loggerDomain(), "Checker queries discharged by abstract interpretation");
+
+        if (not prefilter.get(false)) return false;
+        // a discharged query is not proven by the solver, so it gives no summary
+        if (PredicateStateAnalysis::Summaries() != "none") return false;
+        if (not pass->DM->isAbsIntSafe(di, operand)) return false;
+
+        ++dischargedQueries;
+        dbgs() << "Discharged by abstract interpretation: " << di << endl;
+        return true;
+    }
+
 private:
     static smt::Result checkViolationZ3(
         std::pair<size_t, size_t> memoryBounds,
         PredicateState::Ptr query,
         PredicateState::Ptr state) {
-        Z3::ExprFactory ef;
+        // shared, so that lazy models stored in DefectManager can keep the context alive
+        auto&& ef = std::make_shared<Z3::ExprFactory>();
         Z3::Solver s(ef, memoryBounds.first, memoryBounds.second);
         return s.isViolated(query, state);
     }
@@ -130,49 +156,135 @@ private:
         if(engineName == "allunsat") return smt::UnsatResult();
         UNREACHABLE(tfm::format("Unknown solver specified: %s", engineName));
     }
-public:
+    // queries sharing a state are checked in one solver instance where the engine supports it
+    static std::vector<smt::Result> checkViolations(
+        std::pair<size_t, size_t> memoryBounds,
+        const std::vector<PredicateState::Ptr>& queries,
+        PredicateState::Ptr state) {
+        static config::StringConfigEntry engine{ "analysis", "smt-engine" };
+        auto engineName = engine.get("z3");
 
-    bool check(PredicateState::Ptr query, PredicateState::Ptr state) {
-        return check(query, state, pass->DM->getDefect(defectType, I));
+        if(engineName == "z3") {
+            auto&& ef = std::make_shared<Z3::ExprFactory>();
+            Z3::Solver s(ef, memoryBounds.first, memoryBounds.second);
+            return s.isViolated(queries, state);
+        }
+        if(engineName == "boolector") {
+            Boolector::ExprFactory ef;
+            Boolector::Solver s(ef, memoryBounds.first, memoryBounds.second);
+            return s.isViolated(queries, state);
+        }
+
+        std::vector<smt::Result> results;
+        results.reserve(queries.size());
+        for (auto&& query : queries) {
+            results.push_back(checkViolation(memoryBounds, query, state));
+        }
+        return results;
+    }
+
+    bool report(const smt::Result& solverResult, const DefectInfo& di) {
+        return report(pass->DM, I, solverResult, di);
+    }
+    static bool report(DefectManager* DM, llvm::Instruction* I, const smt::Result& solverResult, const DefectInfo& di) {
+        if (auto satRes = solverResult.getSatPtr()) {
+            AdditionalDefectInfo extra;
+            extra.atFunc = I->getParent()->getParent();
+            extra.atInst = I;
+            extra.satModel = util::just(*satRes);
+            DM->addDefect(di, extra);
+            dbgs() << "Defect confirmed: " << di << endl;
+            return true;
+        } else {
+            DM->addNoDefect(di);
+            dbgs() << "Defect falsified: " << di << endl;
+            if(solverResult.isUnknown()) dbgs() << "{Unknown}" << endl;
+            else dbgs() << "{Unsat}" << endl;
+
+            //if(solverResult.isUnknown()) {
+            //    auto graph = buildGraphRep(state);
+            //    llvm::ViewGraph(&graph, "Unknown state");
+            //}
+
+            return false;
+        }
+    }
+
+    static PendingVerdicts<DefectInfo>& pending() {
+        static PendingVerdicts<DefectInfo> instance;
+        return instance;
+    }
+
+    // solves right away unless the solver budget defers the query,
+    // then the defect is reported once it is solved
+    bool schedule(const DefectInfo& di, const std::vector<PredicateState::Ptr>& measured, SolverScheduler::Solve solve) {
+        auto&& scheduler = SolverScheduler::instance();
+        if (not scheduler.enabled()) return report(solve(), di);
+
+        size_t size = 0;
+        for (auto&& ps : measured) size += TermSizeCalculator::measure(ps).getTermSize();
+
+        auto* DM = pass->DM;
+        auto* inst = I;
+        pending().await(di);
+        scheduler.submit(I->getParent()->getParent(), size, std::move(solve), [DM, inst, di](const smt::Result& result) {
+            report(DM, inst, result, di);
+            pending().settle(di);
+        });
+        return DM->hasDefect(di);
     }
-    bool check(PredicateState::Ptr query, PredicateState::Ptr state, const DefectInfo& di) {
-        TRACE_FUNC;
 
+    static bool alias(DefectManager* DM, llvm::Instruction* I, const DefectInfo& di, const DefectInfo& otherDI) {
+        if(DM->hasDefect(otherDI)) {
+            AdditionalDefectInfo extra;
+            extra.atFunc = I->getParent()->getParent();
+            extra.atInst = I;
+            extra.satModel = DM->getAdditionalInfo(otherDI).satModel;
+            DM->addDefect(di, extra);
+            dbgs() << "Defect confirmed as alias: " << di << endl;
+            return true;
+        } else {
+            DM->addNoDefect(di);
+            dbgs() << "Defect falsified as alias: " << di << endl;
+            return false;
+        }
+    }
+    // normalizes, memory-spaces and slices @state and @queries and runs the interpreter on them,
+    // queries the interpreter proves safe are dropped, the defect is falsified if none is left
+    bool prepare(std::vector<PredicateState::Ptr>& queries, PredicateState::Ptr& state, const DefectInfo& di) {
         auto&& FN = pass->FN;
         auto&& ST = pass->ST;
 
         static config::BoolConfigEntry logQueries("output", "smt-query-logging");
         bool noQueryLogging = not logQueries.get(false);
 
-        dbgs() << "Query size:" << TermSizeCalculator::measure(query) << endl;
-        dbgs() << "State size:" << TermSizeCalculator::measure(state) << endl;
-
-        dbgs() << "Defect: " << di << endl;
-        dbgs() << "Checking: " << ST->toString(I) << endl;
-        if(!noQueryLogging) dbgs() << "  Query: " << query << endl;
-
-        if (not query or not state) return false;
-        if (query->isEmpty()) return false;
-        if (state->isEmpty()) return true;
-
         static config::BoolConfigEntry useLocalAA("analysis", "use-local-aa");
         static config::BoolConfigEntry doSlicing("analysis", "do-slicing");
 
+        auto&& chained = [&]() {
+            auto res = state;
+            for (auto&& query : queries) res = FN.State->Chain(res, query);
+            return res;
+        };
+
         Normalizer nl(FN);
         state = nl.transform(state);
-        query = nl.transform(query);
+        for (auto&& query : queries) query = nl.transform(query);
 
-        MemorySpacer msp(FN, FN.State->Chain(state, query));
+        MemorySpacer msp(FN, chained());
         state = msp.transform(state);
-        query = msp.transform(query);
+        for (auto&& query : queries) query = msp.transform(query);
 
         PoorMem2Reg m2r(FN);
         state = m2r.transform(state);
-        query = m2r.transform(query);
+        for (auto&& query : queries) query = m2r.transform(query);
 
         if(doSlicing.get(true)) {
             dbgs() << "Slicing started" << endl;
-            auto sliced = StateSlicer(FN, query, useLocalAA.get(false)? nullptr : pass->AA).transform(state);
+            // the state is sliced once, keeping everything any of the queries depends on
+            auto joined = queries.front();
+            for (auto&& query : util::tail(queries)) joined = FN.State->Chain(joined, query);
+            auto sliced = StateSlicer(FN, joined, useLocalAA.get(false)? nullptr : pass->AA).transform(state);
             dbgs() << "Slicing finished" << endl;
             dbgs() << "State size after slicing:" << TermSizeCalculator::measure(sliced) << endl;
             if (state == sliced) {
@@ -188,12 +300,15 @@ public:
         if (enableInterpreter.get(false)) {
             dbgs() << "Interpreting started" << endl;
             auto&& interpreter = absint::OneForOneInterpreter(I, ST, FN);
-            if (not interpreter.check(state, query, di)) {
+            queries = util::viewContainer(queries)
+                .filter([&](auto&& query) { return interpreter.check(state, query, di); })
+                .toVector();
+            if (queries.empty()) {
                 dbgs() << "Interpreter result: {Unsat}" << endl;
                 pass->DM->addNoDefect(di);
                 return false;
             } else {
-                dbgs() << "Interpreter result: {Sat}" << endl;
+                dbgs() << "Interpreter result: {Sat} for " << queries.size() << " queries" << endl;
             }
         } else {
             dbgs() << "Interpreting disabled" << endl;
@@ -202,39 +317,92 @@ public:
         static config::BoolConfigEntry memSpacing("analysis", "memory-spaces");
         if(memSpacing.get(false)) {
             dbgs() << "Memspacing started" << endl;
-            MemorySpacer msp(FN, FN.State->Chain(state, query));
+            MemorySpacer msp(FN, chained());
             state = msp.transform(state);
-            query = msp.transform(query);
+            for (auto&& query : queries) query = msp.transform(query);
             dbgs() << "Memspacing finished" << endl;
         } else {
             dbgs() << "Memspacing disabled" << endl;
         }
 
         if(!noQueryLogging) dbgs() << "  State: " << state << endl;
+        return true;
+    }
+
+public:
+
+    bool check(PredicateState::Ptr query, PredicateState::Ptr state) {
+        return check(query, state, pass->DM->getDefect(defectType, I));
+    }
+    bool check(PredicateState::Ptr query, PredicateState::Ptr state, const DefectInfo& di) {
+        TRACE_FUNC;
+
+        auto&& ST = pass->ST;
+
+        static config::BoolConfigEntry logQueries("output", "smt-query-logging");
+        bool noQueryLogging = not logQueries.get(false);
+
+        dbgs() << "Query size:" << TermSizeCalculator::measure(query) << endl;
+        dbgs() << "State size:" << TermSizeCalculator::measure(state) << endl;
+
+        dbgs() << "Defect: " << di << endl;
+        dbgs() << "Checking: " << ST->toString(I) << endl;
+        if(!noQueryLogging) dbgs() << "  Query: " << query << endl;
+
+        if (not query or not state) return false;
+        if (query->isEmpty()) return false;
+        if (state->isEmpty()) return true;
+
+        std::vector<PredicateState::Ptr> queries{ query };
+        if (not prepare(queries, state, di)) return false;
+        query = queries.front();
 
         auto&& fMemInfo = pass->FM->getMemoryBounds(I->getParent()->getParent());
 
-        auto solverResult = checkViolation(fMemInfo, query, state);
-        if (auto satRes = solverResult.getSatPtr()) {
-            pass->DM->addDefect(di);
-            pass->DM->getAdditionalInfo(di).satModel = util::just(*satRes);
-            pass->DM->getAdditionalInfo(di).atFunc = I->getParent()->getParent();
-            pass->DM->getAdditionalInfo(di).atInst = I;
-            dbgs() << "Defect confirmed: " << di << endl;
-            return true;
-        } else {
-            pass->DM->addNoDefect(di);
-            dbgs() << "Defect falsified: " << di << endl;
-            if(solverResult.isUnknown()) dbgs() << "{Unknown}" << endl;
-            else dbgs() << "{Unsat}" << endl;
+        return schedule(di, { state, query }, [=]() {
+            return checkViolation(fMemInfo, query, state);
+        });
+    }
 
-            //if(solverResult.isUnknown()) {
-            //    auto graph = buildGraphRep(state);
-            //    llvm::ViewGraph(&graph, "Unknown state");
-            //}
+    bool check(std::vector<PredicateState::Ptr> queries, PredicateState::Ptr state) {
+        return check(std::move(queries), state, pass->DM->getDefect(defectType, I));
+    }
+    // checks several queries against the same state at once,
+    // the defect is confirmed if any of them is violated
+    bool check(std::vector<PredicateState::Ptr> queries, PredicateState::Ptr state, const DefectInfo& di) {
+        TRACE_FUNC;
 
-            return false;
-        }
+        auto&& ST = pass->ST;
+
+        queries = util::viewContainer(queries)
+            .filter([](auto&& query) { return query and not query->isEmpty(); })
+            .toVector();
+        if (queries.size() == 1) return check(queries.front(), state, di);
+
+        dbgs() << "Queries: " << queries.size() << endl;
+        dbgs() << "State size:" << TermSizeCalculator::measure(state) << endl;
+
+        dbgs() << "Defect: " << di << endl;
+        dbgs() << "Checking: " << ST->toString(I) << endl;
+
+        if (queries.empty() or not state) return false;
+        if (state->isEmpty()) return true;
+
+        if (not prepare(queries, state, di)) return false;
+
+        auto&& fMemInfo = pass->FM->getMemoryBounds(I->getParent()->getParent());
+
+        auto measured = queries;
+        measured.push_back(state);
+        return schedule(di, measured, [=]() {
+            if (queries.size() == 1) return checkViolation(fMemInfo, queries.front(), state);
+
+            auto&& results = checkViolations(fMemInfo, queries, state);
+            for (auto&& result : results) {
+                if (result.isSat()) return result;
+            }
+            return results.back();
+        });
     }
 
     bool alias(llvm::Instruction* other) {
@@ -246,18 +414,21 @@ public:
         dbgs() << "Checking: " << ST->toString(I) << endl;
         dbgs() << "Using explicit defect result info" << endl;
 
-        if(pass->DM->hasDefect(otherDI)) {
-            pass->DM->addDefect(di);
-            pass->DM->getAdditionalInfo(di).satModel = pass->DM->getAdditionalInfo(otherDI).satModel;
-            pass->DM->getAdditionalInfo(di).atFunc = I->getParent()->getParent();
-            pass->DM->getAdditionalInfo(di).atInst = I;
-            dbgs() << "Defect confirmed as alias: " << di << endl;
-            return true;
-        } else {
-            pass->DM->addNoDefect(di);
-            dbgs() << "Defect falsified as alias: " << di << endl;
+        // the verdict for the other defect is deferred by the solver scheduler,
+        // so is this one, anything aliasing this defect waits for it as well
+        if (pending().isPending(otherDI)) {
+            dbgs() << "Waiting for the verdict on: " << otherDI << endl;
+            auto* DM = pass->DM;
+            auto* inst = I;
+            pending().await(di);
+            pending().wait(otherDI, [DM, inst, di, otherDI]() {
+                alias(DM, inst, di, otherDI);
+                pending().settle(di);
+            });
             return false;
         }
+
+        return alias(pass->DM, I, di, otherDI);
     }
 
     bool isReachable(PredicateState::Ptr state) {
@@ -13,6 +13,7 @@
 #include "Codegen/intrinsics_manager.h"
 #include "Passes/Checker/CheckHelper.hpp"
 #include "Passes/Checker/CheckNullDereferencePass.h"
+#include "Passes/Checker/ValueNumberingPass.h"
 #include "State/PredicateStateBuilder.h"
 
 namespace borealis {
@@ -65,21 +66,34 @@ private:
         auto* ptr = I.getPointerOperand();
         if(isNonNull(ptr)) return;
 
+        auto* operand = ptr;
+
         ptr = stripAllOffsets(ptr);
 
-        if(auto&& iopt = util::at(p2i, ptr)) {
+        llvm::Instruction* prev = nullptr;
+        if(auto&& iopt = util::at(p2i, ptr)) prev = iopt.getUnsafe();
+        // pointers provably equal to the one checked by a dominating instruction
+        else if(auto&& eopt = checks.findEquivalent(ptr, &I)) prev = eopt.getUnsafe();
+
+        if(prev) {
             CheckHelper<CheckNullDereferencePass> h(pass, &I, DefectType::INI_03);
 
             if (h.skip()) return;
 
-            h.alias(iopt.getUnsafe());
+            h.alias(prev);
         } else {
             p2i[ptr] = &I;
+            checks.record(ptr, &I);
 
             CheckHelper<CheckNullDereferencePass> h(pass, &I, DefectType::INI_03);
 
             if (h.skip()) return;
 
+            if (h.discharged(operand)) {
+                pass->DM->addNoDefect(pass->DM->getDefect(DefectType::INI_03, &I));
+                return;
+            }
+
             auto q = (
                 pass->FN.State *
                 pass->FN.Predicate->getInequalityPredicate(
@@ -95,7 +109,7 @@ private:
 
 public:
 
-    CheckNullsVisitor(CheckNullDereferencePass* pass) : pass(pass) {}
+    CheckNullsVisitor(CheckNullDereferencePass* pass, ValueNumbering& VN) : pass(pass), checks(VN) {}
 
     void visitLoadInst(llvm::LoadInst& I) {
         visitMemoryInst(I);
@@ -114,6 +128,7 @@ private:
 
     CheckNullDereferencePass* pass;
     std::unordered_map<llvm::Value*, llvm::Instruction*> p2i;
+    EquivalentChecks checks;
 
 };
 
@@ -134,6 +149,7 @@ void CheckNullDereferencePass::getAnalysisUsage(llvm::AnalysisUsage& AU) const {
     AUX<NameTracker>::addRequiredTransitive(AU);
     AUX<SlotTrackerPass>::addRequiredTransitive(AU);
     AUX<SourceLocationTracker>::addRequiredTransitive(AU);
+    AUX<ValueNumberingPass>::addRequiredTransitive(AU);
 }
 
 bool CheckNullDereferencePass::runOnFunction(llvm::Function& F) {
@@ -153,7 +169,7 @@ bool CheckNullDereferencePass::runOnFunction(llvm::Function& F) {
     ST = &GetAnalysis<SlotTrackerPass>::doit(this, F);
     FN = FactoryNest(F.getDataLayout(), ST->getSlotTracker(F));
 
-    CheckNullsVisitor cnv(this);
+    CheckNullsVisitor cnv(this, GetAnalysis<ValueNumberingPass>::doit(this, F).getValueNumbering());
     cnv.visit(F);
 
     DM->sync();
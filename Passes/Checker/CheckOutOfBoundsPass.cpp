@@ -9,6 +9,7 @@
 
 #include "Passes/Checker/CheckHelper.hpp"
 #include "Passes/Checker/CheckOutOfBoundsPass.h"
+#include "Passes/Checker/ValueNumberingPass.h"
 #include "Passes/Tracker/SlotTrackerPass.h"
 #include "State/PredicateStateBuilder.h"
 #include "Term/TermBuilder.h"
@@ -24,19 +25,109 @@ class GepInstVisitor : public llvm::InstVisitor<GepInstVisitor> {
 
 public:
 
-    GepInstVisitor(CheckOutOfBoundsPass* pass) : pass(pass) {}
+    GepInstVisitor(CheckOutOfBoundsPass* pass, ValueNumbering& VN) : checks(VN), pass(pass) {}
 
     void visitGEPOperator(llvm::Instruction& loc, llvm::GEPOperator& GI) {
-        if(visited.count(&GI)) return;
-        visited.insert(&GI);
+        if (auto&& prev = findEquivalent(loc, GI)) {
+            CheckHelper<CheckOutOfBoundsPass> h(pass, &loc, DefectType::BUF_01);
+            if (h.skip()) return;
+
+            h.alias(prev.getUnsafe());
+            return;
+        }
+
+        auto q = buildQuery(loc, GI);
+        if (not q) return;
 
         CheckHelper<CheckOutOfBoundsPass> h(pass, &loc, DefectType::BUF_01);
+        if (h.skip()) return;
+
+        if (h.discharged(&GI)) {
+            pass->DM->addNoDefect(pass->DM->getDefect(DefectType::BUF_01, &loc));
+            return;
+        }
+
+        auto ps = pass->getInstructionState(&loc);
+
+        checks.record(&GI, &loc);
+        h.check(q, ps);
+    }
+
+    void visitGetElementPtrInst(llvm::GetElementPtrInst& GI) {
+        visitGEPOperator(GI, llvm::cast<llvm::GEPOperator>(GI));
+    }
 
-        if (isTriviallyInboundsGEP(&GI)) return;
-        if (GI.isDereferenceablePointer(loc.getDataLayout())) return;
+    void visitInstruction(llvm::Instruction& I) {
+        // all the operands share the instruction state, so they are checked together
+        std::vector<llvm::GEPOperator*> operators;
+        std::vector<PredicateState::Ptr> queries;
+        std::vector<llvm::Instruction*> equivalents;
+        for (auto&& op : util::viewContainer(I.operands())
+                         .map(llvm::dyn_caster<llvm::GEPOperator>())
+                         .filter()) {
+            if (auto&& prev = findEquivalent(I, *op)) {
+                equivalents.push_back(prev.getUnsafe());
+            } else if (auto&& q = buildQuery(I, *op)) {
+                operators.push_back(op);
+                queries.push_back(q);
+            }
+        }
+        if (queries.empty() and equivalents.empty()) return;
 
+        CheckHelper<CheckOutOfBoundsPass> h(pass, &I, DefectType::BUF_01);
         if (h.skip()) return;
 
+        // a confirmed equivalent operator is enough, and the verdict of any of them
+        // stands for the whole instruction when there is nothing else to check
+        for (auto&& prev : equivalents) {
+            if (pass->DM->hasDefect(DefectType::BUF_01, prev)) {
+                h.alias(prev);
+                return;
+            }
+        }
+
+        // operators proven in bounds do not need a query at all
+        std::vector<llvm::GEPOperator*> remaining;
+        std::vector<PredicateState::Ptr> remainingQueries;
+        for (auto i = 0U; i < operators.size(); ++i) {
+            if (h.discharged(operators[i])) continue;
+            remaining.push_back(operators[i]);
+            remainingQueries.push_back(queries[i]);
+        }
+        operators = std::move(remaining);
+        queries = std::move(remainingQueries);
+
+        if (queries.empty()) {
+            if (equivalents.empty()) pass->DM->addNoDefect(pass->DM->getDefect(DefectType::BUF_01, &I));
+            else h.alias(equivalents.front());
+            return;
+        }
+
+        auto ps = pass->getInstructionState(&I);
+
+        for (auto&& op : operators) checks.record(op, &I);
+        h.check(std::move(queries), ps);
+    }
+
+private:
+
+    // the instruction which has already checked an operator equal to @GI and dominates @loc
+    util::option<llvm::Instruction*> findEquivalent(llvm::Instruction& loc, llvm::GEPOperator& GI) {
+        if (visited.count(&GI)) return util::nothing();
+
+        auto&& prev = checks.findEquivalent(&GI, &loc);
+        if (prev) visited.insert(&GI);
+        return prev;
+    }
+
+    // returns nullptr for operators that were already visited or cannot go out of bounds
+    PredicateState::Ptr buildQuery(llvm::Instruction& loc, llvm::GEPOperator& GI) {
+        if(visited.count(&GI)) return nullptr;
+        visited.insert(&GI);
+
+        if (isTriviallyInboundsGEP(&GI)) return nullptr;
+        if (GI.isDereferenceablePointer(loc.getDataLayout())) return nullptr;
+
         auto shift = (
             pass->FN.Term *
             pass->FN.Term->getValueTerm(&GI)
@@ -44,7 +135,7 @@ public:
             pass->FN.Term->getValueTerm(GI.getPointerOperand())
         );
 
-        auto q = (
+        return (
             pass->FN.State *
             pass->FN.Predicate->getEqualityPredicate(
                 pass->FN.Term->getCmpTerm(
@@ -55,26 +146,9 @@ public:
                 pass->FN.Term->getTrueTerm()
             )
         )();
-        auto ps = pass->getInstructionState(&loc);
-
-        h.check(q, ps);
     }
 
-    void visitGetElementPtrInst(llvm::GetElementPtrInst& GI) {
-        visitGEPOperator(GI, llvm::cast<llvm::GEPOperator>(GI));
-    }
-
-    void visitInstruction(llvm::Instruction& I) {
-
-        for (auto&& op : util::viewContainer(I.operands())
-                         .map(llvm::dyn_caster<llvm::GEPOperator>())
-                         .filter()) {
-            visitGEPOperator(I, *op);
-        }
-    }
-
-private:
-
+    EquivalentChecks checks;
     CheckOutOfBoundsPass* pass;
 
 };
@@ -95,6 +169,7 @@ void CheckOutOfBoundsPass::getAnalysisUsage(llvm::AnalysisUsage& AU) const {
     AUX<FunctionManager>::addRequiredTransitive(AU);
     AUX<PredicateStateAnalysis>::addRequiredTransitive(AU);
     AUX<SlotTrackerPass>::addRequiredTransitive(AU);
+    AUX<ValueNumberingPass>::addRequiredTransitive(AU);
 }
 
 bool CheckOutOfBoundsPass::runOnFunction(llvm::Function& F) {
@@ -111,7 +186,7 @@ bool CheckOutOfBoundsPass::runOnFunction(llvm::Function& F) {
     ST = &GetAnalysis<SlotTrackerPass>::doit(this, F);
     FN = FactoryNest(F.getDataLayout(), ST->getSlotTracker(F));
 
-    GepInstVisitor giv(this);
+    GepInstVisitor giv(this, GetAnalysis<ValueNumberingPass>::doit(this, F).getValueNumbering());
     giv.visit(F);
 
     DM->sync();
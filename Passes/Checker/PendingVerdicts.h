@@ -0,0 +1,63 @@
+/*
+ * PendingVerdicts.h
+ */
+
+#ifndef CHECKER_PENDINGVERDICTS_H_
+#define CHECKER_PENDINGVERDICTS_H_
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace borealis {
+
+// Defects whose verdicts the solver scheduler has not given yet,
+// and what is waiting for them (aliases of these defects).
+// A key stays pending until every verdict awaited for it is settled,
+// then the callbacks waiting for it are run in the order they came
+template<class Key>
+class PendingVerdicts {
+
+    struct Entry {
+        size_t verdicts = 0;
+        std::vector<std::function<void()>> waiting;
+    };
+
+    std::unordered_map<Key, Entry> entries;
+
+public:
+
+    void await(const Key& key) {
+        ++entries[key].verdicts;
+    }
+
+    void settle(const Key& key) {
+        auto&& it = entries.find(key);
+        if (it == entries.end()) return;
+        if (--it->second.verdicts > 0) return;
+
+        auto waiting = std::move(it->second.waiting);
+        entries.erase(it);
+        // callbacks may await and settle other keys
+        for (auto&& callback : waiting) callback();
+    }
+
+    bool isPending(const Key& key) const {
+        return entries.count(key) > 0;
+    }
+
+    // @callback is run once @key is settled, @key must be pending
+    void wait(const Key& key, std::function<void()> callback) {
+        entries.at(key).waiting.push_back(std::move(callback));
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+};
+
+} /* namespace borealis */
+
+#endif /* CHECKER_PENDINGVERDICTS_H_ */
@@ -0,0 +1,214 @@
+/*
+ * SolverScheduler.cpp
+ */
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "Config/config.h"
+#include "Passes/Checker/SolverScheduler.h"
+#include "SMT/QueryTimeout.h"
+#include "Statistics/statistics.h"
+#include "Util/time.hpp"
+
+#include "Util/macros.h"
+
+namespace borealis {
+
+static config::IntConfigEntry SolverBudget("analysis", "solver-budget");
+static config::IntConfigEntry SolverBudgetReserve("analysis", "solver-budget-reserve");
+
+static Statistic QueriesDeferred("solver-budget", "deferred", "Solver queries deferred to the end of the module");
+static Statistic QueriesRetried("solver-budget", "retried", "Unknown solver queries retried with leftover budget");
+static Statistic QueriesRecovered("solver-budget", "recovered", "Unknown solver queries decided when retried");
+static Statistic QueriesDropped("solver-budget", "dropped", "Deferred solver queries left unknown with no budget left");
+
+// no query is worth starting with less than that
+static constexpr unsigned long long MinTimeout = 10ULL;
+
+SolverScheduler& SolverScheduler::instance() {
+    static SolverScheduler instance;
+    return instance;
+}
+
+SolverScheduler::SolverScheduler():
+    SolverScheduler(
+        static_cast<millis>(std::max(SolverBudget.get(0), 0)),
+        static_cast<millis>(std::max(SolverBudgetReserve.get(20), 0))
+    ) {}
+
+SolverScheduler::SolverScheduler(unsigned long long budget, unsigned long long reservePercent):
+    budget(budget), reserve(budget * std::min(reservePercent, 100ULL) / 100ULL) {}
+
+void SolverScheduler::enter(const llvm::Module* M) {
+    if (module == M) return;
+    if (module) finish();
+
+    module = M;
+    functions = std::count_if(M->begin(), M->end(), [](auto&& F) { return not F.isDeclaration(); });
+    started = 0;
+    spent = 0;
+}
+
+SolverScheduler::Account& SolverScheduler::account(const llvm::Function* F) {
+    auto&& it = accounts.find(F);
+    if (it != accounts.end()) return it->second;
+
+    // functions that came first and did not use up their shares leave more for the rest
+    auto main = budget - reserve;
+    auto mainLeft = main > spent ? main - spent : 0ULL;
+    auto functionsLeft = functions > started ? functions - started : 1ULL;
+    ++started;
+
+    order.push_back(F);
+    auto&& res = accounts[F];
+    res.allowance = mainLeft / functionsLeft;
+    return res;
+}
+
+SolverScheduler::millis SolverScheduler::left() const {
+    return budget > spent ? budget - spent : 0ULL;
+}
+
+SolverScheduler::millis SolverScheduler::estimate(size_t size) const {
+    if (observedSize == 0) return 0ULL;
+    return static_cast<millis>(static_cast<double>(observedTime) / observedSize * size);
+}
+
+smt::Result SolverScheduler::run(Query& query, millis timeout) {
+    query.timeout = timeout;
+
+    util::StopWatch timer;
+    auto&& result = [&]() {
+        smt::QueryTimeout scope(static_cast<unsigned>(timeout));
+        return query.solve();
+    }();
+    auto elapsed = static_cast<millis>(std::chrono::duration_cast<std::chrono::milliseconds>(timer.duration()).count());
+
+    spent += elapsed;
+    accounts[query.F].spent += elapsed;
+    if (not result.isUnknown()) {
+        observedTime += elapsed;
+        observedSize += query.size;
+    }
+    return result;
+}
+
+void SolverScheduler::retain(std::vector<Query>& queue, Query&& query) {
+    retainedTerms += query.size;
+    peakRetainedTerms = std::max(peakRetainedTerms, retainedTerms);
+    queue.push_back(std::move(query));
+}
+
+void SolverScheduler::submit(const llvm::Function* F, size_t size, Solve solve, Report report) {
+    ASSERTC(enabled());
+    enter(F->getParent());
+
+    auto&& acc = account(F);
+    ++acc.queries;
+
+    Query query{ F, size, std::move(solve), std::move(report), 0ULL };
+
+    auto remaining = acc.allowance > acc.spent ? acc.allowance - acc.spent : 0ULL;
+    auto expected = estimate(size);
+    if (remaining < MinTimeout || expected > remaining) {
+        dbgs() << "Deferring a query of " << size << " terms in " << F->getName().str()
+               << ": expected " << expected << "ms, " << remaining << "ms left" << endl;
+        ++acc.deferred;
+        ++QueriesDeferred;
+        retain(deferred, std::move(query));
+        return;
+    }
+
+    auto&& result = run(query, remaining);
+    if (result.isUnknown()) {
+        // reported once it is retried
+        ++acc.unknown;
+        retain(unknowns, std::move(query));
+        return;
+    }
+    query.report(result);
+}
+
+void SolverScheduler::finish() {
+    if (not module) return;
+
+    auto&& bySize = [](const Query& lhv, const Query& rhv) { return lhv.size < rhv.size; };
+
+    std::stable_sort(deferred.begin(), deferred.end(), bySize);
+    for (auto i = 0U; i < deferred.size(); ++i) {
+        auto&& query = deferred[i];
+        auto share = left() / (deferred.size() - i);
+        if (share < MinTimeout) {
+            ++QueriesDropped;
+            ++accounts[query.F].unknown;
+            query.report(smt::UnknownResult());
+            continue;
+        }
+
+        auto&& result = run(query, share);
+        if (result.isUnknown()) {
+            ++accounts[query.F].unknown;
+            // still retained, it only moves to the other queue
+            unknowns.push_back(std::move(query));
+            continue;
+        }
+        query.report(result);
+    }
+
+    std::stable_sort(unknowns.begin(), unknowns.end(), bySize);
+    for (auto i = 0U; i < unknowns.size(); ++i) {
+        auto&& query = unknowns[i];
+        auto share = left() / (unknowns.size() - i);
+        // the same timeout would give the same answer
+        if (share <= query.timeout) {
+            query.report(smt::UnknownResult());
+            continue;
+        }
+
+        ++QueriesRetried;
+        ++accounts[query.F].retried;
+
+        auto&& result = run(query, share);
+        if (result.isUnknown()) {
+            query.report(result);
+            continue;
+        }
+
+        ++QueriesRecovered;
+        --accounts[query.F].unknown;
+        query.report(result);
+    }
+
+    summarize();
+
+    deferred.clear();
+    unknowns.clear();
+    retainedTerms = 0;
+    peakRetainedTerms = 0;
+    accounts.clear();
+    order.clear();
+    module = nullptr;
+}
+
+void SolverScheduler::summarize() {
+    auto&& info = infos();
+    info << "Solver budget: spent " << spent << "ms of " << budget << "ms, "
+         << "deferred and unknown queries kept up to " << peakRetainedTerms << " terms alive" << endl;
+    for (auto* F : order) {
+        auto&& acc = accounts.at(F);
+        info << "  " << F->getName().str() << ": "
+             << acc.spent << "ms of " << acc.allowance << "ms, "
+             << acc.queries << " queries, "
+             << acc.deferred << " deferred, "
+             << acc.retried << " retried, "
+             << acc.unknown << " unknown" << endl;
+    }
+}
+
+} /* namespace borealis */
+
+#include "Util/unmacros.h"
@@ -0,0 +1,112 @@
+/*
+ * SolverScheduler.h
+ */
+
+#ifndef PASSES_CHECKER_SOLVERSCHEDULER_H_
+#define PASSES_CHECKER_SOLVERSCHEDULER_H_
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "Logging/logger.hpp"
+#include "SMT/Result.h"
+
+namespace llvm {
+class Function;
+class Module;
+} // namespace llvm
+
+namespace borealis {
+
+// Shares a solver time budget of a module between its functions and their queries.
+// Every function gets a fair share of what is left of the budget (minus a reserve)
+// when its first query comes, and its queries are solved with what is left of that share.
+// Queries that do not fit (judging by their size and the time queries took so far)
+// are deferred to the end of the module, cheapest first, and then queries that came out
+// unknown are retried with whatever budget is left.
+// Does nothing unless analysis.solver-budget is set
+class SolverScheduler : public borealis::logging::ClassLevelLogging<SolverScheduler> {
+
+public:
+
+#include "Util/macros.h"
+    static constexpr auto loggerDomain() QUICK_RETURN("solver-budget")
+#include "Util/unmacros.h"
+
+    using Solve = std::function<smt::Result()>;
+    using Report = std::function<void(const smt::Result&)>;
+
+    static SolverScheduler& instance();
+
+    // the one instance() returns is configured by analysis.solver-budget and solver-budget-reserve,
+    // this one is for tests: @budget in ms, @reservePercent of it kept for deferred and unknown queries
+    SolverScheduler(unsigned long long budget, unsigned long long reservePercent);
+
+    bool enabled() const { return budget > 0; }
+
+    // solves the query of @size terms made in @F right away, or defers it to finish(),
+    // @report gets the result either way, exactly once: unknown results are reported
+    // by finish(), after the retry
+    void submit(const llvm::Function* F, size_t size, Solve solve, Report report);
+
+    // solves the deferred queries, retries the unknown ones and reports the budget spent by every function
+    void finish();
+
+private:
+
+    using millis = unsigned long long;
+
+    struct Query {
+        const llvm::Function* F;
+        size_t size;
+        Solve solve;
+        Report report;
+        millis timeout;
+    };
+
+    struct Account {
+        millis allowance = 0;
+        millis spent = 0;
+        size_t queries = 0;
+        size_t deferred = 0;
+        size_t retried = 0;
+        size_t unknown = 0;
+    };
+
+    millis budget;
+    millis reserve;
+    millis spent = 0;
+
+    const llvm::Module* module = nullptr;
+    size_t functions = 0;
+    size_t started = 0;
+
+    // queries with a definite answer only, unknown ones say nothing about how long they need
+    millis observedTime = 0;
+    size_t observedSize = 0;
+
+    std::unordered_map<const llvm::Function*, Account> accounts;
+    std::vector<const llvm::Function*> order;
+    std::vector<Query> deferred;
+    std::vector<Query> unknowns;
+    // terms of the deferred and unknown queries, kept alive until finish()
+    size_t retainedTerms = 0;
+    size_t peakRetainedTerms = 0;
+
+    SolverScheduler();
+
+    void enter(const llvm::Module* M);
+    Account& account(const llvm::Function* F);
+    millis left() const;
+    // 0 if there is nothing to go by yet
+    millis estimate(size_t size) const;
+    smt::Result run(Query& query, millis timeout);
+    void retain(std::vector<Query>& queue, Query&& query);
+    void summarize();
+
+};
+
+} /* namespace borealis */
+
+#endif /* PASSES_CHECKER_SOLVERSCHEDULER_H_ */
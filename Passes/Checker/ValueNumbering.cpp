@@ -0,0 +1,95 @@
+/*
+ * ValueNumbering.cpp
+ */
+
+#include <llvm/IR/Operator.h>
+
+#include "Passes/Checker/ValueNumbering.h"
+#include "Statistics/statistics.h"
+
+#include "Util/macros.h"
+
+namespace borealis {
+
+static Statistic QueriesAvoided("value-numbering",
+    "queries-avoided", "Checker queries answered by an equivalent dominating query");
+
+ValueNumbering::ValueNumbering(llvm::Function& F) {
+    DT.recalculate(F);
+
+    // every block starts a new generation, and so does every instruction that may write to memory
+    auto generation = 0U;
+    for (auto&& BB : F) {
+        ++generation;
+        for (auto&& I : BB) {
+            if (llvm::isa<llvm::LoadInst>(I)) memoryGenerations[&I] = generation;
+            if (I.mayWriteToMemory()) ++generation;
+        }
+    }
+}
+
+unsigned ValueNumbering::number(const Key& key) {
+    auto&& it = expressions.find(key);
+    if (it != expressions.end()) return it->second;
+
+    auto res = static_cast<unsigned>(expressions.size());
+    expressions[key] = res;
+    return res;
+}
+
+unsigned ValueNumbering::getNumber(llvm::Value* v) {
+    auto&& it = numbers.find(v);
+    if (it != numbers.end()) return it->second;
+
+    unsigned res;
+    auto* op = llvm::dyn_cast<llvm::Operator>(v);
+    if (op and (op->getOpcode() == llvm::Instruction::BitCast
+                or op->getOpcode() == llvm::Instruction::AddrSpaceCast)) {
+        res = getNumber(op->getOperand(0));
+    } else if (auto* gep = llvm::dyn_cast<llvm::GEPOperator>(v)) {
+        Key key{ llvm::Instruction::GetElementPtr,
+                 reinterpret_cast<uintptr_t>(gep->getPointerOperandType()),
+                 reinterpret_cast<uintptr_t>(gep->getType()) };
+        for (auto&& operand : gep->operands()) key.push_back(getNumber(operand));
+        res = number(key);
+    } else if (auto* load = llvm::dyn_cast<llvm::LoadInst>(v)) {
+        if (load->isVolatile() or load->isAtomic()) {
+            res = number({ reinterpret_cast<uintptr_t>(v) });
+        } else {
+            res = number({ llvm::Instruction::Load,
+                           reinterpret_cast<uintptr_t>(load->getType()),
+                           getNumber(load->getPointerOperand()),
+                           memoryGenerations.at(load) });
+        }
+    } else {
+        res = number({ reinterpret_cast<uintptr_t>(v) });
+    }
+
+    numbers[v] = res;
+    return res;
+}
+
+bool ValueNumbering::dominates(llvm::Instruction* def, llvm::Instruction* use) const {
+    return DT.dominates(def, use);
+}
+
+util::option<llvm::Instruction*> EquivalentChecks::findEquivalent(llvm::Value* v, llvm::Instruction* at) {
+    auto&& it = checked.find(VN.getNumber(v));
+    if (it == checked.end()) return util::nothing();
+
+    for (auto&& prev : it->second) {
+        if (prev != at and VN.dominates(prev, at)) {
+            ++QueriesAvoided;
+            return util::just(prev);
+        }
+    }
+    return util::nothing();
+}
+
+void EquivalentChecks::record(llvm::Value* v, llvm::Instruction* at) {
+    checked[VN.getNumber(v)].push_back(at);
+}
+
+} /* namespace borealis */
+
+#include "Util/unmacros.h"
@@ -0,0 +1,70 @@
+/*
+ * ValueNumbering.h
+ */
+
+#ifndef CHECKER_VALUENUMBERING_H_
+#define CHECKER_VALUENUMBERING_H_
+
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/Function.h>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "Util/option.hpp"
+
+namespace borealis {
+
+// Lightweight per-function value numbering over pointer-producing instructions,
+// used by the checkers to recognize queries about provably equal pointers.
+// Pointer casts share the number of their operand, GEPs are numbered by their
+// base and indices, and loads of the same pointer are equal as long as
+// nothing may write to memory between them within a basic block.
+// Numbers are assigned on first request, so one numbering serves all the checkers of a function
+class ValueNumbering {
+
+public:
+
+    explicit ValueNumbering(llvm::Function& F);
+
+    unsigned getNumber(llvm::Value* v);
+
+    bool dominates(llvm::Instruction* def, llvm::Instruction* use) const;
+
+private:
+
+    using Key = std::vector<uintptr_t>;
+
+    unsigned number(const Key& key);
+
+    llvm::DominatorTree DT;
+
+    std::unordered_map<llvm::Value*, unsigned> numbers;
+    std::unordered_map<llvm::Value*, unsigned> memoryGenerations;
+    std::map<Key, unsigned> expressions;
+
+};
+
+// Instructions a single checker has already checked, grouped by the numbers of the checked values
+class EquivalentChecks {
+
+public:
+
+    explicit EquivalentChecks(ValueNumbering& VN): VN(VN) {}
+
+    // the instruction which has already been checked for a value equivalent to @v
+    // and which dominates @at, if any
+    util::option<llvm::Instruction*> findEquivalent(llvm::Value* v, llvm::Instruction* at);
+    void record(llvm::Value* v, llvm::Instruction* at);
+
+private:
+
+    ValueNumbering& VN;
+    std::unordered_map<unsigned, std::vector<llvm::Instruction*>> checked;
+
+};
+
+} /* namespace borealis */
+
+#endif /* CHECKER_VALUENUMBERING_H_ */
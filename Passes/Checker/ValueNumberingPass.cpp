@@ -0,0 +1,28 @@
+/*
+ * ValueNumberingPass.cpp
+ */
+
+#include "Passes/Checker/ValueNumberingPass.h"
+#include "Util/util.h"
+
+namespace borealis {
+
+ValueNumberingPass::ValueNumberingPass() : ProxyFunctionPass(ID) {}
+ValueNumberingPass::ValueNumberingPass(llvm::Pass* pass) : ProxyFunctionPass(ID, pass) {}
+
+void ValueNumberingPass::getAnalysisUsage(llvm::AnalysisUsage& AU) const {
+    AU.setPreservesAll();
+}
+
+bool ValueNumberingPass::runOnFunction(llvm::Function& F) {
+    VN = util::uniq(new ValueNumbering(F));
+    return false;
+}
+
+ValueNumberingPass::~ValueNumberingPass() {}
+
+char ValueNumberingPass::ID;
+static RegisterPass<ValueNumberingPass>
+X("value-numbering", "Value numbering of pointers shared by the checkers");
+
+} /* namespace borealis */
@@ -0,0 +1,43 @@
+/*
+ * ValueNumberingPass.h
+ */
+
+#ifndef CHECKER_VALUENUMBERINGPASS_H_
+#define CHECKER_VALUENUMBERINGPASS_H_
+
+#include <llvm/Pass.h>
+
+#include <memory>
+
+#include "Passes/Checker/ValueNumbering.h"
+#include "Passes/Util/ProxyFunctionPass.h"
+#include "Util/passes.hpp"
+
+namespace borealis {
+
+// Value numbering and dominator tree of a function, built once for all the checkers
+class ValueNumberingPass :
+        public ProxyFunctionPass,
+        public ShouldBeLazyModularized {
+
+public:
+
+    static char ID;
+
+    ValueNumberingPass();
+    ValueNumberingPass(llvm::Pass* pass);
+    virtual bool runOnFunction(llvm::Function& F) override;
+    virtual void getAnalysisUsage(llvm::AnalysisUsage& AU) const override;
+    virtual ~ValueNumberingPass();
+
+    ValueNumbering& getValueNumbering() { return *VN; }
+
+private:
+
+    std::unique_ptr<ValueNumbering> VN;
+
+};
+
+} /* namespace borealis */
+
+#endif /* CHECKER_VALUENUMBERINGPASS_H_ */
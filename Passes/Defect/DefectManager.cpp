@@ -5,14 +5,58 @@
  *      Author: ice-phoenix
  */
 
+#include "Logging/async_appender.hpp"
+#include "Passes/Checker/SolverScheduler.h"
 #include "Passes/Defect/DefectManager.h"
 #include "Passes/Tracker/SourceLocationTracker.h"
 #include "Util/passes.hpp"
 
 namespace borealis {
 
+static config::StringConfigEntry DefectStreamOpt("output", "defect-stream");
+static config::StringConfigEntry DefectStreamFormatOpt("output", "defect-stream-format");
+static config::IntConfigEntry DefectStreamBufferOpt("output", "defect-stream-buffer");
+static config::BoolConfigEntry DefectStreamModelsOpt("output", "defect-stream-models");
+
+static const char* verdictName(AdditionalDefectInfo::RunResult result) {
+    using RunResult = AdditionalDefectInfo::RunResult;
+    switch (result) {
+        case RunResult::Proven:       return "proven";
+        case RunResult::Disproven:    return "disproven";
+        case RunResult::Controversal: return "controversal";
+        case RunResult::NotRun:       return "confirmed";
+    }
+    return "confirmed";
+}
+
 DefectManager::DefectManager() : llvm::ModulePass(ID) {}
 
+bool DefectManager::keepsSupplemental() const {
+    // the stream has everything but the models and the places of defects,
+    // and nobody else reads them unless the defects are replayed
+    return not getDefectStream().isOpen() || modelsRequested();
+}
+
+void DefectManager::requestModels() {
+    modelsRequested() = true;
+}
+
+bool DefectManager::runOnModule(llvm::Module& M) {
+    std::string filename = DefectStreamOpt.get("");
+    if (filename.empty() || getDefectStream().isOpen()) return false;
+
+    util::replace("%s", M.getModuleIdentifier(), filename);
+
+    auto&& format = DefectStreamFormatOpt.get("jsonl");
+    auto buffer = DefectStreamBufferOpt.get(64);
+    getDefectStream().open(
+        filename,
+        "sarif" == format ? DefectStream::Format::Sarif : DefectStream::Format::JsonLines,
+        buffer > 0 ? static_cast<size_t>(buffer) * 1024 : 0
+    );
+    return false;
+}
+
 void DefectManager::getAnalysisUsage(llvm::AnalysisUsage& AU) const {
     AU.setPreservesAll();
 
@@ -28,8 +72,40 @@ void DefectManager::addDefect(const std::string& type, llvm::Instruction* where)
 }
 
 void DefectManager::addDefect(const DefectInfo& info) {
-    getStaticData().trueData.insert(info);
-    getSupplemental().insert({info, {}});
+    auto inserted = getStaticData().trueData.insert(info).second;
+    if (keepsSupplemental()) getSupplemental().insert({info, {}});
+    if (inserted) stream(info, verdictName(AdditionalDefectInfo::RunResult::NotRun), AdditionalDefectInfo{});
+}
+
+void DefectManager::addDefect(const DefectInfo& info, const AdditionalDefectInfo& extra) {
+    auto inserted = getStaticData().trueData.insert(info).second;
+    if (not keepsSupplemental()) {
+        if (inserted) stream(info, verdictName(AdditionalDefectInfo::RunResult::NotRun), extra);
+        return;
+    }
+
+    auto&& supplemental = getSupplemental()[info];
+    supplemental.atFunc = extra.atFunc;
+    supplemental.atInst = extra.atInst;
+    supplemental.satModel = extra.satModel;
+    // a lazy model would keep the whole solver context alive as long as the defect is
+    if (supplemental.satModel) supplemental.satModel.getUnsafe().getModel().materialize();
+    if (inserted) stream(info, verdictName(AdditionalDefectInfo::RunResult::NotRun), supplemental);
+}
+
+void DefectManager::setRunResult(const DefectInfo& info, AdditionalDefectInfo::RunResult result) {
+    auto&& supplemental = getSupplemental()[info];
+    supplemental.runResult = result;
+    // a replay that did not finish leaves the defect as it was
+    if (result != AdditionalDefectInfo::RunResult::NotRun) stream(info, verdictName(result), supplemental);
+}
+
+void DefectManager::stream(const DefectInfo& info, const std::string& verdict, const AdditionalDefectInfo& extra) {
+    auto&& out = getDefectStream();
+    if (not out.isOpen()) return;
+
+    static auto withModels = DefectStreamModelsOpt.get(false);
+    out.write(info, verdict, extra.atFunc, withModels ? extra.satModel : util::option<smt::SatResult>{});
 }
 
 void DefectManager::addNoDefect(const DefectInfo& info) {
@@ -41,6 +117,14 @@ void DefectManager::addNoAbsIntDefect(const DefectInfo& info) {
     getStaticData().falseData.insert(info);
 }
 
+void DefectManager::addAbsIntSafe(const DefectInfo& info, const llvm::Value* operand) {
+    getAbsIntSafe().insert({info, operand});
+}
+
+bool DefectManager::isAbsIntSafe(const DefectInfo& info, const llvm::Value* operand) const {
+    return util::contains(getAbsIntSafe(), std::make_pair(info, operand));
+}
+
 const AdditionalDefectInfo& DefectManager::getAdditionalInfo(const DefectInfo& di) const {
     auto&& ret = util::at(getSupplemental(), di);
     if(ret) {
@@ -83,6 +167,14 @@ bool DefectManager::hasInfo(const DefectInfo& di) const {
             util::contains(getStaticData().falseAbsIntData, di);
 }
 
+void DefectManager::sync() {
+    if(impl_::persistentDefectDataSync.get(false)) {
+        getStaticData().sync();
+    }
+    getDefectStream().flush();
+    // the log of a function is written out together with its defects
+    logging::flushAsyncAppenders();
+}
 
 void DefectManager::print(llvm::raw_ostream&, const llvm::Module*) const {
     for (const auto& defect : getStaticData().trueData) {
@@ -91,7 +183,12 @@ void DefectManager::print(llvm::raw_ostream&, const llvm::Module*) const {
 }
 
 bool DefectManager::doFinalization(llvm::Module &module) {
+    // verdicts deferred by the solver budget are in before anything is dumped,
+    // even if no pass asked for them earlier
+    SolverScheduler::instance().finish();
     getStaticData().forceDump();
+    getDefectStream().close();
+    getAbsIntSafe().clear();
     return llvm::Pass::doFinalization(module);
 }
 
@@ -17,6 +17,7 @@
 
 #include "Logging/logger.hpp"
 #include "Passes/Defect/DefectManager/DefectInfo.h"
+#include "Passes/Defect/DefectManager/DefectStream.h"
 #include "Util/json.hpp"
 
 namespace borealis {
@@ -155,11 +156,12 @@ public:
 
     typedef std::unordered_set<DefectInfo> DefectData;
     typedef std::unordered_map<DefectInfo, AdditionalDefectInfo> AdditionalDefectData;
+    typedef std::unordered_set<std::pair<DefectInfo, const llvm::Value*>> AbsIntSafeData;
 
     static char ID;
 
     DefectManager();
-    virtual bool runOnModule(llvm::Module&) override { return false; }
+    virtual bool runOnModule(llvm::Module&) override;
 
     virtual bool doFinalization(llvm::Module &module) override;
 
@@ -172,13 +174,25 @@ public:
     void addDefect(DefectType type, llvm::Instruction* where);
     void addDefect(const std::string& type, llvm::Instruction* where);
     void addDefect(const DefectInfo& info);
+    // same, but with where and why the defect was confirmed
+    void addDefect(const DefectInfo& info, const AdditionalDefectInfo& extra);
 
     void addNoDefect(const DefectInfo& info);
     void addNoAbsIntDefect(const DefectInfo& info);
+    // a single operand checked at @info proven safe by abstract interpretation,
+    // even if other operands at the same place are not
+    void addAbsIntSafe(const DefectInfo& info, const llvm::Value* operand);
+    bool isAbsIntSafe(const DefectInfo& info, const llvm::Value* operand) const;
 
     const AdditionalDefectInfo& getAdditionalInfo(const DefectInfo&) const;
     AdditionalDefectInfo& getAdditionalInfo(const DefectInfo&);
 
+    void setRunResult(const DefectInfo& info, AdditionalDefectInfo::RunResult result);
+
+    // the report of confirmed defects written while the analysis goes,
+    // not open unless output.defect-stream is set
+    DefectStream& getStream() const { return getDefectStream(); }
+
     DefectInfo getDefect(DefectType type, llvm::Instruction* where) const;
     DefectInfo getDefect(const std::string& type, llvm::Instruction* where) const;
 
@@ -190,11 +204,7 @@ public:
 
     virtual void print(llvm::raw_ostream&, const llvm::Module*) const override;
 
-    void sync() {
-        if(impl_::persistentDefectDataSync.get(false)) {
-            getStaticData().sync();
-        }
-    }
+    void sync();
 
 private:
 
@@ -208,10 +218,34 @@ private:
         return data;
     }
 
+    static AbsIntSafeData& getAbsIntSafe() {
+        static AbsIntSafeData data;
+        return data;
+    }
+
+    static DefectStream& getDefectStream() {
+        static DefectStream stream;
+        return stream;
+    }
+
+    static bool& modelsRequested() {
+        static bool requested = false;
+        return requested;
+    }
+
+    // whether the models and the places of confirmed defects are kept:
+    // always, unless they go to the stream and no pass has requested them
+    bool keepsSupplemental() const;
+    void stream(const DefectInfo& info, const std::string& verdict, const AdditionalDefectInfo& extra);
+
 public:
 
     const DefectData& getData() const { return getStaticData().trueData; }
 
+    // called from doInitialization() of the passes reading the models and the places of the defects
+    // (getAdditionalInfo), so that they are kept even if the defects go to the stream
+    static void requestModels();
+
 #include "Util/macros.h"
     auto begin() QUICK_CONST_RETURN(getStaticData().trueData.begin())
     auto end() QUICK_CONST_RETURN(getStaticData().trueData.end())
@@ -0,0 +1,182 @@
+/*
+ * DefectStream.cpp
+ */
+
+#include <llvm/IR/Function.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <unistd.h>
+
+#include <sstream>
+#include <unordered_map>
+
+#include "Logging/logger.hpp"
+#include "Passes/Defect/DefectManager/DefectStream.h"
+#include "Statistics/statistics.h"
+#include "Util/json.hpp"
+
+#include "Util/macros.h"
+
+namespace borealis {
+
+static Statistic RecordsStreamed("defect-stream", "records", "Defect records written to the report stream");
+static Statistic StreamFlushes("defect-stream", "flushes", "Times the defect report buffer was written out");
+
+static const std::string SarifHeader =
+    R"({"$schema":"https://json.schemastore.org/sarif-2.1.0.json","version":"2.1.0",)"
+    R"("runs":[{"tool":{"driver":{"name":"borealis"}},"results":[)";
+static const std::string SarifFooter = "]}]}";
+
+static std::string toLine(const util::json::Value& value) {
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    value.accept(writer);
+    return std::string(sb.GetString(), sb.GetSize());
+}
+
+static util::json::Value toSarif(const DefectInfo& di, util::json::Value&& properties) {
+    util::json::Value result{ util::json::Value::Object };
+
+    result["ruleId"] = di.type;
+    result["level"] = "error";
+
+    auto&& known = DefectTypesByName.find(di.type);
+    result["message"]["text"] = known != DefectTypesByName.end()
+                                ? DefectTypes.at(known->second).description
+                                : di.type;
+
+    util::json::Value physical{ util::json::Value::Object };
+    physical["artifactLocation"]["uri"] = di.location.filename.str();
+    if (di.location.loc.line != LocalLocus::UNKNOWN_LOC) {
+        physical["region"]["startLine"] = di.location.loc.line;
+        if (di.location.loc.col != LocalLocus::UNKNOWN_LOC && di.location.loc.col > 0) {
+            physical["region"]["startColumn"] = di.location.loc.col;
+        }
+    }
+    util::json::Value location{ util::json::Value::Object };
+    location["physicalLocation"] = std::move(physical);
+    result["locations"].push_back(std::move(location));
+
+    // everything needed to read the record back, in our own format
+    result["properties"] = std::move(properties);
+    return std::move(result);
+}
+
+DefectStream::~DefectStream() {
+    close();
+}
+
+void DefectStream::open(const std::string& filename, Format format, size_t bufferSize) {
+    close();
+
+    this->filename = filename;
+    this->format = format;
+    this->bufferSize = bufferSize;
+    this->records = 0;
+    this->owner = getpid();
+
+    buffer.clear();
+    buffer.reserve(bufferSize);
+
+    out.open(filename, std::ios::out | std::ios::trunc);
+    if (not out) {
+        errs() << "Cannot open defect report stream \"" << filename << "\"" << endl;
+        return;
+    }
+
+    if (Format::Sarif == format) {
+        buffer += SarifHeader;
+        buffer += '\n';
+        flush();
+    }
+}
+
+void DefectStream::close() {
+    if (not isOpen()) return;
+    if (owner != getpid()) return;
+
+    if (Format::Sarif == format) {
+        buffer += SarifFooter;
+        buffer += '\n';
+    }
+    flush();
+    out.close();
+}
+
+void DefectStream::flush() {
+    if (not isOpen() || buffer.empty()) return;
+    if (owner != getpid()) return;
+
+    out.write(buffer.data(), buffer.size());
+    out.flush();
+    buffer.clear();
+    ++StreamFlushes;
+}
+
+void DefectStream::write(
+        const DefectInfo& di,
+        const std::string& verdict,
+        const llvm::Function* where,
+        const util::option<smt::SatResult>& model) {
+    if (not isOpen()) return;
+
+    util::json::Value record{ util::json::Value::Object };
+    record["defect"] = util::toJson(di);
+    record["verdict"] = verdict;
+    if (where) record["function"] = where->getName().str();
+    if (model) {
+        std::ostringstream ost;
+        ost << model.getUnsafe();
+        record["model"] = ost.str();
+    }
+
+    if (Format::Sarif == format) {
+        if (records > 0) buffer += ',';
+        buffer += toLine(toSarif(di, std::move(record)));
+    } else {
+        buffer += toLine(record);
+    }
+    buffer += '\n';
+    ++records;
+    ++RecordsStreamed;
+
+    if (buffer.size() >= bufferSize) flush();
+}
+
+DefectStream::Verdicts DefectStream::read(const std::string& filename) {
+    Verdicts res;
+    std::unordered_map<DefectInfo, size_t> index;
+
+    std::ifstream in(filename);
+    std::string line;
+    while (std::getline(in, line)) {
+        // SARIF results are separated by commas, and the header and footer lines never parse
+        if (not line.empty() && line.front() == ',') line.erase(0, 1);
+        if (line.empty() || line.front() != '{') continue;
+
+        std::istringstream ist(line);
+        util::json::Value value;
+        ist >> value;
+        if (not value.isObject()) continue;
+
+        auto record = value["properties"].isObject() ? value["properties"] : value;
+        auto&& di = util::fromJson<DefectInfo>(record["defect"]);
+        auto&& verdict = util::fromJson<std::string>(record["verdict"]);
+        if (not di || not verdict) continue;
+
+        auto&& it = index.find(*di);
+        if (it == index.end()) {
+            index.emplace(*di, res.size());
+            res.emplace_back(*di, *verdict);
+        } else {
+            res[it->second].second = *verdict;
+        }
+    }
+
+    return std::move(res);
+}
+
+} /* namespace borealis */
+
+#include "Util/unmacros.h"
@@ -0,0 +1,76 @@
+/*
+ * DefectStream.h
+ */
+
+#ifndef DEFECTSTREAM_H_
+#define DEFECTSTREAM_H_
+
+#include <sys/types.h>
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Passes/Defect/DefectManager/DefectInfo.h"
+#include "Util/option.hpp"
+
+namespace llvm {
+class Function;
+} // namespace llvm
+
+namespace borealis {
+
+// Report written while the analysis goes, one self-contained record per line.
+// Records are kept in a bounded buffer and written out when it is full,
+// so a report of any size never has to be held in memory.
+// A later record for the same defect overrides the earlier ones (e.g. a verdict from tassadar).
+// JSON-lines reports stay readable even if the analysis is killed halfway,
+// SARIF ones get their closing brackets only when the stream is closed
+class DefectStream {
+
+public:
+
+    enum class Format { JsonLines, Sarif };
+
+    typedef std::vector<std::pair<DefectInfo, std::string>> Verdicts;
+
+    DefectStream() = default;
+    ~DefectStream();
+
+    DefectStream(const DefectStream&) = delete;
+    DefectStream& operator=(const DefectStream&) = delete;
+
+    // @bufferSize is in bytes, 0 writes every record right away
+    void open(const std::string& filename, Format format, size_t bufferSize);
+    void close();
+    void flush();
+
+    bool isOpen() const { return out.is_open(); }
+    const std::string& getFilename() const { return filename; }
+
+    void write(
+        const DefectInfo& di,
+        const std::string& verdict,
+        const llvm::Function* where,
+        const util::option<smt::SatResult>& model);
+
+    // the latest verdict for every defect in a report, in the order defects were first met
+    static Verdicts read(const std::string& filename);
+
+private:
+
+    std::string filename;
+    std::ofstream out;
+    std::string buffer;
+    size_t bufferSize = 0;
+    Format format = Format::JsonLines;
+    size_t records = 0;
+    // forked workers inherit the stream, but only its owner may write it out
+    pid_t owner = 0;
+
+};
+
+} /* namespace borealis */
+
+#endif /* DEFECTSTREAM_H_ */
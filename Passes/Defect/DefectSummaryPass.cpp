@@ -9,10 +9,12 @@
 #include <clang/Basic/SourceManager.h>
 
 #include <fstream>
+#include <unordered_set>
 
 #include "Codegen/llvm.h"
 #include "Config/config.h"
 #include "Passes/Checker/Defines.def"
+#include "Passes/Checker/SolverScheduler.h"
 #include "Passes/Defect/DefectSummaryPass.h"
 #include "Passes/Util/DataProvider.hpp"
 #include "Util/json.hpp"
@@ -36,11 +38,33 @@ void DefectSummaryPass::getAnalysisUsage(llvm::AnalysisUsage& AU) const {
 
 bool DefectSummaryPass::runOnModule(llvm::Module& M) {
 
+    // queries deferred by the solver budget may still confirm something
+    SolverScheduler::instance().finish();
+
     auto& dm = GetAnalysis<DefectManager>::doit(this);
 
     auto* mainFileEntry = M.getModuleIdentifier().c_str();
 
-    std::vector<DefectInfo> results(dm.begin(), dm.end());
+    std::vector<DefectInfo> results;
+    std::unordered_set<DefectInfo> disproven;
+
+    auto&& stream = dm.getStream();
+    if (stream.isOpen()) {
+        // the summary has exactly what the report has
+        stream.flush();
+        for (auto&& record : DefectStream::read(stream.getFilename())) {
+            results.push_back(record.first);
+            if ("disproven" == record.second) disproven.insert(record.first);
+        }
+    } else {
+        results.assign(dm.begin(), dm.end());
+        for (auto&& defect : results) {
+            if (dm.getAdditionalInfo(defect).runResult == AdditionalDefectInfo::RunResult::Disproven) {
+                disproven.insert(defect);
+            }
+        }
+    }
+
     std::sort(results.begin(), results.end(), [](DefectInfo& a, DefectInfo& b) -> bool {
         return a < b;
     });
@@ -51,7 +75,7 @@ bool DefectSummaryPass::runOnModule(llvm::Module& M) {
             infos() << defect.type
                     << " (cannot trace location)"
                     << endl
-                    << (dm.getAdditionalInfo(defect).runResult == AdditionalDefectInfo::RunResult::Disproven ? "Disproven by tassadar\n" : "");
+                    << (util::contains(disproven, defect) ? "Disproven by tassadar\n" : "");
             continue;
         }
 
@@ -79,7 +103,7 @@ bool DefectSummaryPass::runOnModule(llvm::Module& M) {
                 << ln
                 << pt << endl
                 << getRawSource(after) << endl
-                << (dm.getAdditionalInfo(defect).runResult == AdditionalDefectInfo::RunResult::Disproven ? "Disproven by tassadar\n" : "")
+                << (util::contains(disproven, defect) ? "Disproven by tassadar\n" : "")
                 ;
     }
 
@@ -5,8 +5,19 @@
  *      Author: ice-phoenix
  */
 
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/Support/raw_ostream.h>
+
 #include "Annotation/LogicAnnotation.h"
 #include "Codegen/intrinsics_manager.h"
+#include "Config/config.h"
 #include "Passes/Manager/AnnotationManager.h"
 #include "Passes/Manager/FunctionManager.h"
 #include "Passes/Tracker/VariableInfoTracker.h"
@@ -22,9 +33,26 @@
 
 namespace borealis {
 
+static config::ConfigEntry<int> DefaultMallocSize("analysis", "default-malloc-size");
+static config::ConfigEntry<int> MemoryRegionSlack("analysis", "memory-region-slack");
+static config::StringConfigEntry SummaryStorePath("analysis", "summary-store");
+static config::StringConfigEntry SummaryMode("summary", "sum-mode");
+static config::StringConfigEntry PSAMode("analysis", "psa-mode");
+static config::MultiConfigEntry FunctionDefinitionFiles("analysis", "ext-functions");
+// do not affect the manager itself, but change the summaries it keeps
+static config::BoolConfigEntry AdaptiveDeroll("analysis", "adaptive-deroll");
+static config::BoolConfigEntry DerollBackstab("analysis", "deroll-backstab");
+static config::BoolConfigEntry OptimizeStates("analysis", "optimize-states");
+static config::BoolConfigEntry DoSlicing("analysis", "do-slicing");
+static config::BoolConfigEntry MemorySpaces("analysis", "memory-spaces");
+
+// globals are allocated below the first region
+static constexpr unsigned long long FirstRegionStart = 1ULL << 16;
+static constexpr unsigned long long MinRegionSize = 1ULL << 16;
+
 ////////////////////////////////////////////////////////////////////////////////
 
-FunctionManager::FunctionManager() : llvm::ModulePass(ID) {}
+FunctionManager::FunctionManager() : llvm::ModulePass(ID), store(SummaryStorePath.get("")) {}
 
 void FunctionManager::getAnalysisUsage(llvm::AnalysisUsage& AU) const {
     AU.setPreservesAll();
@@ -45,6 +73,8 @@ bool FunctionManager::runOnModule(llvm::Module& M) {
     unsigned int i = 1;
     for (auto&& F : M) ids[&F] = i++;
 
+    allocateRegions(M);
+
     for (auto&& a : annotations) {
         // FIXME: check this!!!
         auto&& anno = materialize(a, FN, &meta);
@@ -171,16 +201,57 @@ unsigned int FunctionManager::getId(const llvm::Function* F) const {
     return ids.at(F);
 }
 
-unsigned int FunctionManager::getMemoryStart(const llvm::Function* F) const {
-    return (getId(F) << 16) + 1;
+unsigned long long FunctionManager::getMemoryStart(const llvm::Function* F) const {
+    return getMemoryBounds(F).first;
+}
+
+unsigned long long FunctionManager::getMemoryEnd(const llvm::Function* F) const {
+    return getMemoryBounds(F).second;
+}
+
+FunctionManager::MemoryBounds FunctionManager::getMemoryBounds(const llvm::Function* F) const {
+    ASSERTC(util::containsKey(regions, F));
+    return regions.at(F);
 }
 
-unsigned int FunctionManager::getMemoryEnd(const llvm::Function* F) const {
-    return (getId(F) + 1) << 16;
+unsigned long long FunctionManager::estimateMemoryUsage(const llvm::Function& F) const {
+    auto&& DL = F.getParent()->getDataLayout();
+    auto&& defaultSize = static_cast<unsigned long long>(DefaultMallocSize.get(2048));
+    auto&& im = IntrinsicsManager::getInstance();
+
+    unsigned long long cells = 0ULL;
+    for (auto&& I : util::view(llvm::inst_begin(F), llvm::inst_end(F))) {
+        if (auto* alloca = llvm::dyn_cast<llvm::AllocaInst>(&I)) {
+            // not mutated yet, so count bytes, which is never less than cells
+            auto&& count = llvm::dyn_cast<llvm::ConstantInt>(alloca->getArraySize());
+            cells += DL->getTypeAllocSize(alloca->getAllocatedType()) * (count ? count->getLimitedValue() : defaultSize);
+        } else if (auto* call = llvm::dyn_cast<llvm::CallInst>(&I)) {
+            auto&& ft = im.getIntrinsicType(*call);
+            if (ft != function_type::INTRINSIC_ALLOC && ft != function_type::INTRINSIC_MALLOC) continue;
+            // the first argument is the resolved size in cells
+            auto&& size = llvm::dyn_cast<llvm::ConstantInt>(call->getArgOperand(0));
+            cells += size ? size->getLimitedValue() : defaultSize;
+        }
+    }
+    // every allocation takes twice its size in the execution context
+    return 2 * cells;
 }
 
-std::pair<unsigned int, unsigned int> FunctionManager::getMemoryBounds(const llvm::Function* F) const {
-    return { getMemoryStart(F), getMemoryEnd(F) };
+void FunctionManager::allocateRegions(llvm::Module& M) {
+    auto&& slack = static_cast<unsigned long long>(std::max(1, MemoryRegionSlack.get(4)));
+
+    auto start = FirstRegionStart;
+    for (auto&& F : M) {
+        auto size = MinRegionSize;
+        // derolled loops and inlining allocate more than a single pass over the body does
+        auto&& needed = estimateMemoryUsage(F) * slack;
+        while (size < needed) size <<= 1;
+
+        regions[&F] = { start + 1, start + size };
+        start += size;
+    }
+
+    dbgs() << "Allocated " << regions.size() << " memory regions up to " << start << endl;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -197,6 +268,152 @@ auto FunctionManager::getBonds(const llvm::Function* F) const -> decltype(util::
 
 ////////////////////////////////////////////////////////////////////////////////
 
+bool FunctionManager::restoreSummary(const llvm::Function* F) {
+    if (not store.enabled()) return false;
+
+    auto&& entry = store.load(getSummaryKey(F), FN);
+    if (not entry) return false;
+
+    dbgs() << "Restoring shared summary for: " << F->getName().str() << endl;
+
+    update(F, entry.getUnsafe().summary);
+    for (auto&& bond : entry.getUnsafe().bonds) addBond(F, bond);
+    return true;
+}
+
+void FunctionManager::publishSummary(const llvm::Function* F, PredicateState::Ptr summary) {
+    update(F, summary);
+    if (not store.enabled()) return;
+
+    SummaryStore::Entry entry{ summary, {} };
+    for (auto&& bond : getBonds(F)) entry.bonds.push_back(bond.second);
+    store.publish(getSummaryKey(F), entry);
+}
+
+namespace {
+
+// FNV-1a, std::hash is not guaranteed to be stable between runs
+struct StableHash {
+    unsigned long long value = 14695981039346656037ULL;
+
+    void feed(char c) {
+        value ^= static_cast<unsigned char>(c);
+        value *= 1099511628211ULL;
+    }
+
+    StableHash& operator<<(const std::string& str) {
+        for (auto&& c : str) feed(c);
+        feed('\0');
+        return *this;
+    }
+
+    StableHash& operator<<(unsigned long long v) {
+        for (auto i = 0U; i < sizeof(v); ++i) feed(static_cast<char>(v >> (8 * i)));
+        return *this;
+    }
+};
+
+template<class T>
+std::string printed(const T* what) {
+    std::string res;
+    llvm::raw_string_ostream ost(res);
+    what->print(ost);
+    return ost.str();
+}
+
+unsigned long long hashConfiguration() {
+    // bumped whenever the layout of the store or the summaries change
+    static constexpr unsigned long long FormatVersion = 1ULL;
+
+    StableHash hash;
+    hash << FormatVersion << SummaryMode.get("none") << PSAMode.get("one-for-one");
+    // the same defaults as where the options are used
+    for (auto&& flag : { &AdaptiveDeroll, &DerollBackstab, &OptimizeStates, &DoSlicing, &MemorySpaces }) {
+        hash << static_cast<unsigned long long>(flag->get(false));
+    }
+    hash << static_cast<unsigned long long>(DefaultMallocSize.get(2048));
+    for (auto&& filename : FunctionDefinitionFiles) {
+        auto&& source = util::getFilePathIfExists(filename);
+        std::ifstream input(source, std::ios::binary);
+        hash << source << std::string{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+    }
+    return hash.value;
+}
+
+} /* namespace */
+
+unsigned long long FunctionManager::getSummaryKey(const llvm::Function* F) const {
+    if (util::containsKey(summaryKeys, F)) return summaryKeys.at(F);
+
+    static auto configuration = hashConfiguration();
+
+    StableHash hash;
+    hash << configuration << F->getName().str() << printed(F->getFunctionType());
+
+    // summaries refer to local values by the names their terms get from the slot tracker,
+    // so the same code with other names is a different summary
+    auto* st = GetAnalysis<SlotTrackerPass>::doit(this).getSlotTracker(F);
+    ASSERT(st, "Missing SlotTracker for " + F->getName().str());
+    auto&& isLocal = [](const llvm::Value* value) {
+        return llvm::isa<llvm::Argument>(value) || llvm::isa<llvm::Instruction>(value) || llvm::isa<llvm::BasicBlock>(value);
+    };
+
+    // interpolants are computed within the memory region of the function
+    if ("interpol" == SummaryMode.get("none")) {
+        auto&& bounds = getMemoryBounds(F);
+        hash << bounds.first << bounds.second;
+    }
+
+    for (auto&& arg : F->getArgumentList()) hash << st->getLocalName(&arg);
+
+    std::vector<const llvm::Function*> callees;
+    std::unordered_set<const llvm::Function*> seen;
+
+    for (auto&& BB : *F) {
+        hash << "block" << st->getLocalName(&BB);
+        for (auto&& I : BB) {
+            if (llvm::isa<llvm::DbgInfoIntrinsic>(I)) continue;
+
+            hash << static_cast<unsigned long long>(I.getOpcode()) << printed(I.getType());
+            if (not I.getType()->isVoidTy()) hash << st->getLocalName(&I);
+            if (auto* cmp = llvm::dyn_cast<llvm::CmpInst>(&I)) {
+                hash << static_cast<unsigned long long>(cmp->getPredicate());
+            }
+
+            for (auto&& op : I.operands()) {
+                auto* value = op.get();
+                if (isLocal(value)) {
+                    hash << st->getLocalName(value);
+                } else if (auto* global = llvm::dyn_cast<llvm::GlobalValue>(value)) {
+                    hash << "@" + global->getName().str();
+                } else if (auto* constant = llvm::dyn_cast<llvm::Constant>(value)) {
+                    hash << printed(constant);
+                } else {
+                    hash << "?";
+                }
+            }
+
+            if (auto* call = llvm::dyn_cast<llvm::CallInst>(&I)) {
+                auto* callee = call->getCalledFunction();
+                if (callee and callee != F and seen.insert(callee).second) callees.push_back(callee);
+            }
+        }
+    }
+
+    // summaries of callers are made from what is known about the callees right now
+    for (auto* callee : callees) {
+        hash << callee->getName().str();
+        if (util::containsKey(data, callee)) {
+            auto&& desc = data.at(callee);
+            hash << desc.Req->toString() << desc.Bdy->toString() << desc.Ens->toString();
+        }
+    }
+
+    return summaryKeys[F] = hash.value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 FunctionManager::FunctionDesc FunctionManager::mergeFunctionDesc(const FunctionDesc& d1, const FunctionDesc& d2) const {
     return FunctionDesc{
         (FN.State * d1.Req + d2.Req)(),
@@ -15,6 +15,7 @@
 #include "Factory/Nest.h"
 #include "Logging/logger.hpp"
 #include "Passes/Defect/DefectManager/DefectInfo.h"
+#include "Passes/Manager/SummaryStore.h"
 
 namespace borealis {
 
@@ -53,16 +54,22 @@ public:
 
     using FunctionData = std::unordered_map<const llvm::Function*, FunctionDesc>;
     using Ids = std::unordered_map<const llvm::Function*, unsigned int>;
-    using Bond = std::pair<PredicateState::Ptr, DefectInfo>;
+    using MemoryBounds = std::pair<unsigned long long, unsigned long long>;
+    using Regions = std::unordered_map<const llvm::Function*, MemoryBounds>;
+    using Bond = SummaryStore::Bond;
+    using SummaryKeys = std::unordered_map<const llvm::Function*, unsigned long long>;
     using FunctionBonds = std::unordered_multimap<const llvm::Function*, Bond>;
 
 private:
 
     mutable FunctionData data;
     mutable Ids ids;
+    mutable Regions regions;
     mutable FunctionBonds bonds;
+    mutable SummaryKeys summaryKeys;
 
     FactoryNest FN;
+    SummaryStore store;
 
 public:
 
@@ -83,13 +90,19 @@ public:
     PredicateState::Ptr getEns(const llvm::CallInst& CI, FactoryNest FN) const;
 
     unsigned int getId(const llvm::Function* F) const;
-    unsigned int getMemoryStart(const llvm::Function* F) const;
-    unsigned int getMemoryEnd(const llvm::Function* F) const;
-    std::pair<unsigned int, unsigned int> getMemoryBounds(const llvm::Function* F) const;
+    unsigned long long getMemoryStart(const llvm::Function* F) const;
+    unsigned long long getMemoryEnd(const llvm::Function* F) const;
+    MemoryBounds getMemoryBounds(const llvm::Function* F) const;
 
     void addBond(const llvm::Function* F, const Bond& bond);
     auto getBonds(const llvm::Function* F) const -> decltype(util::view(bonds.equal_range(0)));
 
+    // updates @F with its summary made by another run and restores its bonds,
+    // returns false if no run has made it yet
+    bool restoreSummary(const llvm::Function* F);
+    // updates @F with @summary and shares it, together with the bonds of @F, with other runs
+    void publishSummary(const llvm::Function* F, PredicateState::Ptr summary);
+
 private:
 
     FunctionDesc get(const llvm::Function* F) const;
@@ -97,6 +110,14 @@ private:
 
     FunctionDesc mergeFunctionDesc(const FunctionDesc& d1, const FunctionDesc& d2) const;
 
+    // upper estimate of the local memory cells @F allocates along a single path
+    unsigned long long estimateMemoryUsage(const llvm::Function& F) const;
+    void allocateRegions(llvm::Module& M);
+
+    // stable between runs, covers the body of @F, the states of the functions it calls
+    // and the configuration summaries depend on
+    unsigned long long getSummaryKey(const llvm::Function* F) const;
+
 };
 
 } /* namespace borealis */
@@ -0,0 +1,110 @@
+/*
+ * SummaryStore.cpp
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+
+#include <tinyformat/tinyformat.h>
+
+#include "Logging/logger.hpp"
+#include "Passes/Manager/SummaryStore.h"
+#include "Protobuf/Converter.hpp"
+#include "Protobuf/Gen/Passes/Manager/SummaryStore.pb.h"
+#include "Statistics/statistics.h"
+
+#include "Util/macros.h"
+
+namespace borealis {
+
+static Statistic StoreHits("summary-store", "hits", "Function summaries reused from the shared store");
+static Statistic StoreMisses("summary-store", "misses", "Function summaries not found in the shared store");
+static Statistic StorePublished("summary-store", "published", "Function summaries published to the shared store");
+
+SummaryStore::SummaryStore(const std::string& directory): directory(directory) {
+    if (not enabled()) return;
+    if (::mkdir(directory.c_str(), 0777) != 0 and errno != EEXIST) {
+        errs() << "cannot create summary store: " << directory << endl;
+        this->directory.clear();
+    }
+}
+
+std::string SummaryStore::pathFor(unsigned long long key) const {
+    return tfm::format("%s/%016x.summary", directory, key);
+}
+
+util::option<SummaryStore::Entry> SummaryStore::load(unsigned long long key, const FactoryNest& FN) const {
+    if (not enabled()) return util::nothing();
+
+    auto fd = ::open(pathFor(key).c_str(), O_RDONLY);
+    if (fd < 0) {
+        ++StoreMisses;
+        return util::nothing();
+    }
+    ON_SCOPE_EXIT(::close(fd));
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 or st.st_size == 0) return util::nothing();
+
+    auto size = static_cast<size_t>(st.st_size);
+    auto data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) return util::nothing();
+    ON_SCOPE_EXIT(::munmap(data, size));
+
+    proto::Summary summary;
+    if (not summary.ParseFromArray(data, static_cast<int>(size))) return util::nothing();
+    if (summary.key() != key) return util::nothing();
+
+    Entry res{ deprotobuffy(FN, summary.state()), {} };
+    res.bonds.reserve(summary.bonds_size());
+    for (auto&& bond : summary.bonds()) {
+        auto&& location = deprotobuffy(bond.location());
+        res.bonds.push_back({ deprotobuffy(FN, bond.state()), DefectInfo{ bond.defect(), *location } });
+    }
+
+    ++StoreHits;
+    return util::just(std::move(res));
+}
+
+void SummaryStore::publish(unsigned long long key, const Entry& entry) const {
+    if (not enabled()) return;
+
+    proto::Summary summary;
+    summary.set_key(key);
+    summary.set_allocated_state(protobuffy(entry.summary).release());
+    for (auto&& bond : entry.bonds) {
+        auto&& proto = summary.add_bonds();
+        proto->set_allocated_state(protobuffy(bond.first).release());
+        proto->set_defect(bond.second.type);
+        proto->set_allocated_location(protobuffy(bond.second.location).release());
+    }
+
+    // another run may be publishing the same summary right now,
+    // every one of them writes its own file and atomically moves it into place
+    auto&& path = pathFor(key);
+    auto&& temporary = tfm::format("%s.%d", path, ::getpid());
+    {
+        std::ofstream output(temporary, std::ios::binary);
+        if (not summary.SerializeToOstream(&output)) {
+            errs() << "cannot write function summary: " << temporary << endl;
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return;
+    }
+
+    ++StorePublished;
+}
+
+} /* namespace borealis */
+
+#include "Util/unmacros.h"
@@ -0,0 +1,74 @@
+/*
+ * SummaryStore.h
+ */
+
+#ifndef PASSES_MANAGER_SUMMARYSTORE_H_
+#define PASSES_MANAGER_SUMMARYSTORE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Factory/Nest.h"
+#include "Passes/Defect/DefectManager/DefectInfo.h"
+#include "State/PredicateState.h"
+#include "Util/option.hpp"
+
+namespace borealis {
+
+namespace proto { class Summary; }
+/** protobuf -> Passes/Manager/SummaryStore.proto
+import "State/PredicateState.proto";
+import "Util/locations.proto";
+
+package borealis.proto;
+
+message SummaryBond {
+    optional borealis.proto.PredicateState state = 1;
+    optional string defect = 2;
+    optional borealis.proto.Locus location = 3;
+}
+
+message Summary {
+    optional uint64 key = 1;
+    optional borealis.proto.PredicateState state = 2;
+    repeated SummaryBond bonds = 3;
+}
+
+**/
+// Function summaries shared between concurrently running analyses.
+// Every summary is a file in the store directory, named after its key.
+// A file is written under a temporary name and renamed into place, so it is
+// either there in full or not at all, and reading never takes a lock.
+// Keys are stable between runs and must cover everything a summary depends on
+class SummaryStore {
+
+public:
+
+    using Bond = std::pair<PredicateState::Ptr, DefectInfo>;
+
+    struct Entry {
+        PredicateState::Ptr summary;
+        std::vector<Bond> bonds;
+    };
+
+    // an empty @directory disables the store
+    explicit SummaryStore(const std::string& directory);
+
+    bool enabled() const { return not directory.empty(); }
+
+    // the terms of the summary are created with @FN
+    util::option<Entry> load(unsigned long long key, const FactoryNest& FN) const;
+    void publish(unsigned long long key, const Entry& entry) const;
+
+private:
+
+    std::string directory;
+
+    std::string pathFor(unsigned long long key) const;
+
+};
+
+} /* namespace borealis */
+
+#endif /* PASSES_MANAGER_SUMMARYSTORE_H_ */
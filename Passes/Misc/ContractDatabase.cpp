@@ -0,0 +1,278 @@
+/*
+ * ContractDatabase.cpp
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <tinyformat/tinyformat.h>
+
+#include "Annotation/AnnotationCast.h"
+#include "Logging/logger.hpp"
+#include "Passes/Misc/ContractDatabase.h"
+#include "Protobuf/Converter.hpp"
+#include "Protobuf/Gen/Passes/Misc/ContractDatabase.pb.h"
+#include "Util/option.hpp"
+
+#include "Util/macros.h"
+
+namespace borealis {
+
+namespace {
+
+// bumped whenever the layout of the database changes
+constexpr unsigned long long FormatVersion = 1ULL;
+
+unsigned long long hashSources(const std::vector<std::string>& sources) {
+    // FNV-1a, std::hash is not guaranteed to be stable between runs
+    auto hash = 14695981039346656037ULL ^ FormatVersion;
+    auto&& feed = [&](char c) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    };
+
+    for (auto&& source : sources) {
+        for (auto&& c : source) feed(c);
+        feed('\0');
+
+        std::ifstream input(source, std::ios::binary);
+        for (char c; input.get(c);) feed(c);
+        feed('\0');
+    }
+    return hash;
+}
+
+// the database is scanned without parsing it, only the wire format is needed for that
+enum WireType { Varint = 0, Fixed64 = 1, LengthDelimited = 2, Fixed32 = 5 };
+
+bool readVarint(const char*& it, const char* end, unsigned long long& res) {
+    res = 0ULL;
+    for (auto shift = 0U; it != end and shift < 64U; shift += 7U) {
+        auto byte = static_cast<unsigned char>(*it++);
+        res |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        if (not (byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// calls @onField(number, begin, end) for every length-delimited field and @onVarint(number, value)
+// for every varint field between @begin and @end, skipping the rest
+template<class OnField, class OnVarint>
+bool scanFields(const char* begin, const char* end, OnField onField, OnVarint onVarint) {
+    for (auto it = begin; it != end;) {
+        unsigned long long tag;
+        if (not readVarint(it, end, tag)) return false;
+
+        auto number = tag >> 3;
+        switch (tag & 0x7) {
+            case Varint: {
+                unsigned long long value;
+                if (not readVarint(it, end, value)) return false;
+                onVarint(number, value);
+                break;
+            }
+            case Fixed64:
+                if (end - it < 8) return false;
+                it += 8;
+                break;
+            case LengthDelimited: {
+                unsigned long long size;
+                if (not readVarint(it, end, size)) return false;
+                if (static_cast<unsigned long long>(end - it) < size) return false;
+                onField(number, it, it + size);
+                it += size;
+                break;
+            }
+            case Fixed32:
+                if (end - it < 4) return false;
+                it += 4;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+} /* namespace */
+
+ContractDatabase::ContractDatabase(const std::vector<std::string>& sources, const std::string& cache):
+    sources(sources), cache(cache), version(hashSources(sources)) {}
+
+ContractDatabase::~ContractDatabase() {
+    unmap();
+}
+
+void ContractDatabase::unmap() {
+    if (mapped) ::munmap(mapped, mappedSize);
+    mapped = nullptr;
+    mappedSize = 0;
+}
+
+bool ContractDatabase::index(const char* data, size_t size) {
+    static constexpr auto VersionField = 1ULL;
+    static constexpr auto EntriesField = 2ULL;
+    static constexpr auto IdField = 1ULL;
+
+    auto&& ignoreVarint = [](unsigned long long, unsigned long long) {};
+
+    util::option<unsigned long long> found;
+    std::vector<Span> spans;
+    std::vector<std::string> ids;
+    auto malformed = false;
+
+    auto&& scanned = scanFields(data, data + size,
+        [&](unsigned long long number, const char* begin, const char* end) {
+            if (number != EntriesField) return;
+            spans.push_back({ static_cast<size_t>(begin - data), static_cast<size_t>(end - begin) });
+            ids.emplace_back();
+            // entries with broken framing are caught here, the rest when (and if) they are materialized
+            malformed |= not scanFields(begin, end,
+                [&](unsigned long long field, const char* idBegin, const char* idEnd) {
+                    if (field == IdField) ids.back().assign(idBegin, idEnd);
+                },
+                ignoreVarint);
+        },
+        [&](unsigned long long number, unsigned long long value) {
+            if (number == VersionField) found = util::just(value);
+        });
+    if (not scanned or malformed) return false;
+    if (not found or found.getUnsafe() != version) return false;
+
+    this->data = data;
+    entries = std::move(spans);
+    entryIds = std::move(ids);
+    return true;
+}
+
+bool ContractDatabase::load() {
+    auto fd = ::open(cache.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    ON_SCOPE_EXIT(::close(fd));
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 or st.st_size == 0) return false;
+
+    auto size = static_cast<size_t>(st.st_size);
+    auto data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) return false;
+
+    // the mapping stays alive for as long as the entries may be materialized
+    unmap();
+    mapped = data;
+    mappedSize = size;
+
+    if (not index(static_cast<const char*>(data), size)) {
+        unmap();
+        return false;
+    }
+    return true;
+}
+
+void ContractDatabase::build(const FactoryNest& FN) {
+    proto::ContractDatabase db;
+    db.set_version(version);
+
+    for (auto&& source : sources) {
+        std::ifstream input(source);
+        util::json::Value all;
+        input >> all;
+        for (auto&& val : all) {
+            auto opt = util::fromJson<func_info::FuncInfo>(val);
+            if (not opt) {
+                errs() << "cannot parse json: " << val;
+                continue;
+            }
+
+            auto&& entry = db.add_entries();
+            entry->set_id(opt->id);
+
+            std::ostringstream info;
+            util::write_as_json(info, *opt);
+            entry->set_info(info.str());
+
+            for (auto&& contract : opt->contracts) {
+                if (auto&& anno = borealis::fromString(Locus{}, contract, FN.Term)) {
+                    entry->mutable_contracts()->AddAllocated(protobuffy(anno).release());
+                }
+            }
+        }
+    }
+
+    // the database just built is read the same way as the cached one
+    unmap();
+    built.clear();
+    auto&& serialized = db.SerializeToString(&built);
+    ASSERT(serialized, "Cannot serialize the contract database");
+    auto&& indexed = index(built.data(), built.size());
+    ASSERT(indexed, "Cannot read back the contract database");
+
+    if (cache.empty()) return;
+
+    // concurrent runs may build the same database, so every one of them
+    // writes its own file and atomically moves it into place
+    auto&& temporary = tfm::format("%s.%d", cache, ::getpid());
+    {
+        std::ofstream output(temporary, std::ios::binary);
+        if (not output.write(built.data(), static_cast<std::streamsize>(built.size()))) {
+            errs() << "cannot write contract database: " << temporary << endl;
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    if (std::rename(temporary.c_str(), cache.c_str()) != 0) {
+        std::remove(temporary.c_str());
+    }
+}
+
+const std::vector<std::string>& ContractDatabase::ids() const {
+    ASSERTC(data);
+    return entryIds;
+}
+
+util::option<ContractDatabase::Entry> ContractDatabase::decode(size_t index, const FactoryNest& FN) const {
+    auto&& span = entries.at(index);
+    proto::ContractDatabaseEntry entry;
+    if (not entry.ParseFromArray(data + span.offset, static_cast<int>(span.size))) return util::nothing();
+
+    std::istringstream info(entry.info());
+    auto&& funcInfo = util::read_as_json<func_info::FuncInfo>(info);
+    if (not funcInfo) return util::nothing();
+
+    Entry res{ *funcInfo, {} };
+    res.contracts.reserve(entry.contracts_size());
+    for (auto&& contract : entry.contracts()) {
+        auto&& anno = deprotobuffy(FN, contract);
+        if (not anno) return util::nothing();
+        res.contracts.push_back(anno);
+    }
+    return util::just(std::move(res));
+}
+
+util::option<ContractDatabase::Entry> ContractDatabase::materialize(size_t index, const FactoryNest& FN) {
+    ASSERTC(data);
+
+    if (auto&& res = decode(index, FN)) return std::move(res);
+
+    auto id = entryIds.at(index);
+    errs() << "Corrupted contract database entry: " << id << ", rebuilding the database" << endl;
+    build(FN);
+
+    auto&& it = std::find(entryIds.begin(), entryIds.end(), id);
+    if (it == entryIds.end()) return util::nothing();
+
+    auto&& res = decode(static_cast<size_t>(it - entryIds.begin()), FN);
+    ASSERT(res, "Cannot read back the contract database entry: " + id);
+    return std::move(res);
+}
+
+} /* namespace borealis */
+
+#include "Util/unmacros.h"
@@ -0,0 +1,95 @@
+/*
+ * ContractDatabase.h
+ */
+
+#ifndef PASSES_MISC_CONTRACTDATABASE_H_
+#define PASSES_MISC_CONTRACTDATABASE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Annotation/Annotation.h"
+#include "Codegen/FuncInfo.h"
+#include "Factory/Nest.h"
+#include "Util/option.hpp"
+
+namespace borealis {
+
+namespace proto { class ContractDatabase; }
+/** protobuf -> Passes/Misc/ContractDatabase.proto
+import "Annotation/Annotation.proto";
+
+package borealis.proto;
+
+message ContractDatabaseEntry {
+    optional string id = 1;
+    optional string info = 2;
+    repeated borealis.proto.Annotation contracts = 3;
+}
+
+message ContractDatabase {
+    optional uint64 version = 1;
+    repeated ContractDatabaseEntry entries = 2;
+}
+
+**/
+// External function descriptions with their contracts already parsed.
+// The database is built once from the JSON sources and cached in a file
+// versioned by the hash of their contents. The cache is mapped, not parsed:
+// loading only finds where every entry lies and reads its id, so that every
+// other run only decodes the entries for the functions its module actually declares
+class ContractDatabase {
+
+public:
+
+    struct Entry {
+        func_info::FuncInfo info;
+        std::vector<Annotation::Ptr> contracts;
+    };
+
+    ContractDatabase(const std::vector<std::string>& sources, const std::string& cache);
+    ContractDatabase(const ContractDatabase&) = delete;
+    ContractDatabase& operator=(const ContractDatabase&) = delete;
+    ~ContractDatabase();
+
+    // returns false if the cache is missing or was built from other sources
+    bool load();
+    // parses the sources and stores the result in the cache
+    void build(const FactoryNest& FN);
+
+    const std::vector<std::string>& ids() const;
+    // the terms of the contracts are created with @FN;
+    // a corrupted entry makes the database rebuilt from the sources,
+    // nothing is returned if the sources do not describe this function anymore
+    util::option<Entry> materialize(size_t index, const FactoryNest& FN);
+
+private:
+
+    std::vector<std::string> sources;
+    std::string cache;
+    unsigned long long version;
+
+    struct Span {
+        size_t offset;
+        size_t size;
+    };
+
+    // either the mapped cache or the database just built
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+    std::string built;
+
+    const char* data = nullptr;
+    std::vector<Span> entries;
+    std::vector<std::string> entryIds;
+
+    bool index(const char* data, size_t size);
+    util::option<Entry> decode(size_t index, const FactoryNest& FN) const;
+    void unmap();
+
+};
+
+} /* namespace borealis */
+
+#endif /* PASSES_MISC_CONTRACTDATABASE_H_ */
@@ -8,6 +8,7 @@
 #include "Util/passes.hpp"
 #include "Passes/Tracker/SlotTrackerPass.h"
 #include "Passes/Tracker/SourceLocationTracker.h"
+#include "Passes/Misc/ContractDatabase.h"
 #include "Passes/Misc/FuncInfoProvider.h"
 #include "Config/config.h"
 #include "Factory/Nest.h"
@@ -34,12 +35,35 @@ struct FuncInfoProvider::Impl {
             return name;
         }
     }
+
+    llvm::Function* resolve(llvm::Module& M, const std::string& id) {
+        std::string fname = id;
+
+        auto lfn = util::fromString<llvm::LibFunc::Func>(id).getOrElse(llvm::LibFunc::NumLibFuncs);
+
+        if(lfn != llvm::LibFunc::NumLibFuncs) {
+            // XXX: this is somewhat fucked up
+            fname = getNameIgnoringState(lfn);
+        }
+
+        return M.getFunction(fname);
+    }
+
+    void add(llvm::Function* func, func_info::FuncInfo info, std::vector<Annotation::Ptr> annotations) {
+        if(func->isVarArg()) info.argInfo.resize(func->arg_size() + 1);
+        else info.argInfo.resize(func->arg_size());
+
+        auto fname = func->getName().str();
+        functions[fname] = std::move(info);
+        contracts[fname] = std::move(annotations);
+    }
 };
 
 char FuncInfoProvider::ID = 42;
 static RegisterPass<FuncInfoProvider> X("func-info", "Provide function descriptions from external file");
 
 static config::MultiConfigEntry FunctionDefinitionFiles("analysis", "ext-functions");
+static config::StringConfigEntry ContractDatabasePath("analysis", "contract-database");
 
 FuncInfoProvider::FuncInfoProvider() : llvm::ModulePass(ID), pimpl_(std::make_unique<Impl>()) {}
 FuncInfoProvider::~FuncInfoProvider() {}
@@ -64,6 +88,25 @@ bool FuncInfoProvider::runOnModule(llvm::Module& M) {
     auto&& ST = getAnalysis<SlotTrackerPass>();
     auto FN = FactoryNest(M.getDataLayout(), ST.getSlotTracker(M));
 
+    auto&& cache = ContractDatabasePath.get("");
+    if (not cache.empty()) {
+        std::vector<std::string> sources;
+        for(auto&& filename : FunctionDefinitionFiles) sources.push_back(util::getFilePathIfExists(filename));
+
+        ContractDatabase db(sources, cache);
+        if (not db.load()) db.build(FN);
+
+        auto&& ids = db.ids();
+        for(auto i = 0U; i < ids.size(); ++i) {
+            auto func = pimpl_->resolve(M, ids[i]);
+            if(not func) continue;
+
+            auto&& entry = db.materialize(i, FN);
+            if(not entry) continue;
+            pimpl_->add(func, std::move(entry.getUnsafe().info), std::move(entry.getUnsafe().contracts));
+        }
+        return false;
+    }
 
     for(auto&& filename : FunctionDefinitionFiles) {
         std::ifstream input(util::getFilePathIfExists(filename));
@@ -74,26 +117,14 @@ bool FuncInfoProvider::runOnModule(llvm::Module& M) {
             if(!opt) {
                 errs() << "cannot parse json: " << val;
             } else {
-                std::string fname = opt->id;
-
-                auto lfn = util::fromString<llvm::LibFunc::Func>(opt->id).getOrElse(llvm::LibFunc::NumLibFuncs);
-
-                if(lfn != llvm::LibFunc::NumLibFuncs) {
-                    // XXX: this is somewhat fucked up
-                    fname = pimpl_->getNameIgnoringState(lfn);
-                }
-
-                auto func = M.getFunction(fname);
+                auto func = pimpl_->resolve(M, opt->id);
 
                 if(func) {
-                    if(func->isVarArg()) opt->argInfo.resize(func->arg_size() + 1);
-                    else opt->argInfo.resize(func->arg_size());
-
-                    pimpl_->functions[fname] = *opt;
-                    pimpl_->contracts[fname] = util::viewContainer(opt->contracts)
+                    auto&& contracts = util::viewContainer(opt->contracts)
                         .map(LAM(A, borealis::fromString(Locus{}, A, FN.Term)))
                         .filter()
                         .toVector();
+                    pimpl_->add(func, *opt, std::move(contracts));
                 }
             }
         }
@@ -14,6 +14,7 @@
 namespace borealis {
 
 static config::BoolConfigEntry enableAnalysis("absint", "enable-ir-interpreter");
+static config::BoolConfigEntry useSummaries("absint", "use-summaries");
 
 bool IRInterpreterPass::runOnModule(llvm::Module& M) {
     if (not enableAnalysis.get(false)) return false;
@@ -24,16 +25,31 @@ bool IRInterpreterPass::runOnModule(llvm::Module& M) {
     auto&& cgs = &getAnalysis<CallGraphSlicer>();
 
     using namespace absint;
-    auto interpreter = ir::Interpreter(&M, fip, st, cgs);
-    interpreter.run();
-    auto& module = interpreter.getModule();
+    interpreter_ = std::make_unique<ir::Interpreter>(&M, fip, st, cgs);
+    if (useSummaries.get(false)) {
+        SCCPass::runOnModule(M);
+    } else {
+        interpreter_->run();
+    }
+    auto& module = interpreter_->getModule();
 
     ir::OutOfBoundsChecker(&module, dm, fip).run();
     ir::NullDereferenceChecker(&module, dm).run();
+    interpreter_.reset();
+    return false;
+}
+
+bool IRInterpreterPass::runOnSCC(const CallGraphSCC& SCC) {
+    std::vector<const llvm::Function*> functions;
+    for (auto&& node : SCC) {
+        if (auto&& F = node->getFunction()) functions.emplace_back(F);
+    }
+    if (not functions.empty()) interpreter_->interpretSCC(functions);
     return false;
 }
 
 void IRInterpreterPass::getAnalysisUsage(llvm::AnalysisUsage& AU) const {
+    SCCPass::getAnalysisUsage(AU);
     AU.setPreservesAll();
 
     AUX<FuncInfoProvider>::addRequired(AU);
@@ -9,20 +9,28 @@
 
 #include "Annotation/Annotation.h"
 #include "Interpreter/Interpreter.h"
+#include "Passes/Util/SCCPass.h"
 
 namespace borealis {
 
-class IRInterpreterPass : public llvm::ModulePass {
+/// In summary mode call graph is processed bottom-up by SCCs,
+/// and calls are handled with callee summaries instead of on demand interpretation
+class IRInterpreterPass : public SCCPass {
 public:
 
     static char ID;
 
-    IRInterpreterPass() : llvm::ModulePass(ID) {}
+    IRInterpreterPass() : SCCPass(ID) {}
     virtual ~IRInterpreterPass() = default;
 
     virtual bool runOnModule(llvm::Module& M) override;
+    virtual bool runOnSCC(const CallGraphSCC& SCC) override;
     virtual void getAnalysisUsage(llvm::AnalysisUsage& AU) const override;
 
+private:
+
+    std::unique_ptr<absint::ir::Interpreter> interpreter_;
+
 };
 
 }   /* namespace borealis */
@@ -26,6 +26,11 @@ public:
 
     ReanimatorPass() : llvm::ModulePass(ID) {};
 
+    virtual bool doInitialization(llvm::Module&) override {
+        DefectManager::requestModels();
+        return false;
+    }
+
     virtual bool runOnModule(llvm::Module&) override {
         auto&& DM = GetAnalysis<DefectManager>::doit(this);
         auto&& STP = GetAnalysis<SlotTrackerPass>::doit(this);
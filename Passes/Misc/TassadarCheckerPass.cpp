@@ -4,8 +4,13 @@
  *  Created on: Feb 6, 2015
  *      Author: belyaev
  */
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <unordered_map>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <llvm/Pass.h>
 #include <llvm/PassAnalysisSupport.h>
@@ -14,12 +19,15 @@
 
 
 #include "Passes/Checker/Defines.def"
+#include "Passes/Checker/SolverScheduler.h"
 #include "Config/config.h"
+#include "Executor/Exceptions.h"
 #include "Executor/ExecutionEngine.h"
 #include "Executor/SmtDrivenArbiter.h"
 #include "Util/passes.hpp"
 #include "Util/collections.hpp"
 #include "Util/functional.hpp"
+#include "Logging/async_appender.hpp"
 #include "Logging/tracer.hpp"
 #include "Passes/Defect/DefectManager.h"
 
@@ -30,6 +38,13 @@ namespace {
 
 using namespace borealis::config;
 
+static ConfigEntry<int> ReplayJobs("executor", "replay-jobs");
+static ConfigEntry<int> ReplayTimeout("executor", "replay-timeout");
+static ConfigEntry<int> ReplayStepLimit("executor", "replay-step-limit");
+
+// worker exit codes are shifted so that they cannot be confused with a plain exit(0) or abort()
+static constexpr int ReplayExitBase = 100;
+
 static llvm::GenericValue symbolicPtr(ExecutionEngine& ee) {
     llvm::GenericValue retVal;
     retVal.PointerVal = ee.getSymbolicPointer();
@@ -58,58 +73,158 @@ public:
         AU.setPreservesAll();
     }
 
+    bool doInitialization(llvm::Module&) override {
+        DefectManager::requestModels();
+        return false;
+    }
+
     bool runOnModule(llvm::Module& M) override {
         TRACE_FUNC;
 
         auto&& DM = getAnalysis<DefectManager>();
-        for(auto&& defect: DM.getData()) if(auto&& model = DM.getAdditionalInfo(defect).satModel) {
+
+        // defects confirmed by queries deferred by the solver budget are replayed too
+        SolverScheduler::instance().finish();
+
+        std::vector<DefectInfo> defects;
+        for (auto&& defect : DM.getData()) if (auto&& model = DM.getAdditionalInfo(defect).satModel) {
             ASSERT(model.getUnsafe().valid(), "Cannot run tassadar checker without collected data. Did you forget to enable model collection?");
+            defects.push_back(defect);
+        }
+
+        auto jobs = ReplayJobs.get(1);
+        if (jobs > 1) replayParallel(M, DM, defects, static_cast<size_t>(jobs));
+        else for (auto&& defect : defects) {
+            DM.setRunResult(defect, replay(M, DM, defect));
+        }
+
+        return false;
+    }
 
-            dbgs() << "Running tassadar on " << defect << endl;
+private:
 
-            llvm::Function* func = DM.getAdditionalInfo(defect).atFunc;
-            auto st = getAnalysis<SlotTrackerPass>().getSlotTracker(func);
+    using RunResult = AdditionalDefectInfo::RunResult;
 
-            auto judicator = std::make_shared<SmtDrivenArbiter>(M.getDataLayout(), st, model.getUnsafe());
+    RunResult replay(llvm::Module& M, DefectManager& DM, const DefectInfo& defect) {
+        TRACE_FUNC;
 
-            ExecutionEngine tassadar{&M,
-                &getAnalysis<llvm::DataLayoutPass>().getDataLayout(),
-                &getAnalysis<llvm::TargetLibraryInfo>(),
-                &getAnalysis<SlotTrackerPass>(),
-                &getAnalysis<VariableInfoTracker>(),
-                judicator
-            };
+        dbgs() << "Running tassadar on " << defect << endl;
+
+        auto&& model = DM.getAdditionalInfo(defect).satModel;
+        llvm::Function* func = DM.getAdditionalInfo(defect).atFunc;
+        auto st = getAnalysis<SlotTrackerPass>().getSlotTracker(func);
+
+        auto judicator = std::make_shared<SmtDrivenArbiter>(M.getDataLayout(), st, model.getUnsafe());
+
+        ExecutionEngine tassadar{&M,
+            &getAnalysis<llvm::DataLayoutPass>().getDataLayout(),
+            &getAnalysis<llvm::TargetLibraryInfo>(),
+            &getAnalysis<SlotTrackerPass>(),
+            &getAnalysis<VariableInfoTracker>(),
+            judicator
+        };
+        tassadar.setStepLimit(static_cast<size_t>(ReplayStepLimit.get(0)));
+        tassadar.setTimeLimit(static_cast<size_t>(std::max(ReplayTimeout.get(0), 0)));
+
+        auto args =
+            util::viewContainer(func->getArgumentList())
+                .map(LAM(arg, arg.getType()->isPointerTy() ? symbolicPtr(tassadar) : judicator->map(&arg) ))
+                .toVector();
+
+        try {
+            tassadar.runFunction(func, args);
+
+            errs() << "Defect not proven:" << endl
+                   << "    " << defect << endl;
+            return RunResult::Disproven;
+
+        } catch(step_limit_exceeded& ex) {
+            infos() << ex.what() << " checking " << defect << endl;
+            return RunResult::NotRun;
+
+        } catch(time_limit_exceeded& ex) {
+            infos() << ex.what() << " checking " << defect << endl;
+            return RunResult::NotRun;
+
+        } catch(std::exception& ex) {
+            auto infos_ = infos();
+            infos_  << "Exception acquired: " << endl
+                    << ex.what() << endl
+                    << " checking " << defect << endl
+                    << " model: " << endl
+                    << model.getUnsafe();
+            infos_  << "Function: " << llvm::valueSummary(tassadar.getCurrentContext().CurFunction) << endl;
+            if((llvm::Instruction*)tassadar.getCurrentContext().CurInst) {
+                auto&& CurInst = tassadar.getCurrentContext().CurInst;
+                infos_ << "Instruction: " << llvm::valueSummary(*std::prev(CurInst)) << endl;
+            }
 
-            auto args =
-                util::viewContainer(func->getArgumentList())
-                    .map(LAM(arg, arg.getType()->isPointerTy() ? symbolicPtr(tassadar) : judicator->map(&arg) ))
-                    .toVector();
+            return RunResult::Proven;
+        }
+    }
 
-            try {
-                tassadar.runFunction(func, args);
+    // Every defect is replayed in a forked worker: the module and analysis results are shared
+    // copy-on-write, and anything the executor breaks stays inside the worker.
+    // A worker that crashes, hangs past the timeout or runs out of steps leaves the defect not run
+    void replayParallel(llvm::Module& M, DefectManager& DM, const std::vector<DefectInfo>& defects, size_t jobs) {
+        TRACE_FUNC;
 
-                errs() << "Defect not proven:" << endl
-                       << "    " << defect << endl;
-                DM.getAdditionalInfo(defect).runResult = AdditionalDefectInfo::RunResult::Disproven;
-
-            } catch(std::exception& ex) {
-                auto infos_ = infos();
-                infos_  << "Exception acquired: " << endl
-                        << ex.what() << endl
-                        << " checking " << defect << endl
-                        << " model: " << endl
-                        << model.getUnsafe();
-                infos_  << "Function: " << llvm::valueSummary(tassadar.getCurrentContext().CurFunction) << endl;
-                if((llvm::Instruction*)tassadar.getCurrentContext().CurInst) {
-                    auto&& CurInst = tassadar.getCurrentContext().CurInst;
-                    infos_ << "Instruction: " << llvm::valueSummary(*std::prev(CurInst)) << endl;
+        auto timeout = ReplayTimeout.get(0);
+        std::unordered_map<pid_t, DefectInfo> workers;
+
+        auto&& collect = [&]() {
+            int status = 0;
+            auto pid = waitpid(-1, &status, 0);
+            if (pid < 0) return false;
+
+            auto&& it = workers.find(pid);
+            if (it == workers.end()) return true;
+
+            auto result = RunResult::NotRun;
+            if (WIFEXITED(status)) {
+                auto code = WEXITSTATUS(status) - ReplayExitBase;
+                if (code >= static_cast<int>(RunResult::Proven) && code <= static_cast<int>(RunResult::NotRun)) {
+                    result = static_cast<RunResult>(code);
                 }
+            } else {
+                infos() << "Replay worker for " << it->second << " terminated abnormally" << endl;
+            }
 
-                DM.getAdditionalInfo(defect).runResult = AdditionalDefectInfo::RunResult::Proven;
+            if (result == RunResult::Disproven) {
+                errs() << "Defect not proven:" << endl
+                       << "    " << it->second << endl;
             }
+            DM.setRunResult(it->second, result);
+            workers.erase(it);
+            return true;
+        };
+
+        std::cout.flush();
+        std::cerr.flush();
+
+        for (auto&& defect : defects) {
+            while (workers.size() >= jobs && collect());
+
+            auto pid = fork();
+            if (pid < 0) {
+                // cannot fork anymore, fall back to replaying in-process
+                DM.setRunResult(defect, replay(M, DM, defect));
+                continue;
+            }
+            if (pid == 0) {
+                logging::detachAsyncAppenders();
+                // the executor checks the timeout itself, the alarm is for the worker stuck elsewhere
+                if (timeout > 0) alarm(static_cast<unsigned>(timeout) + 1U);
+                auto result = replay(M, DM, defect);
+                std::cout.flush();
+                std::cerr.flush();
+                // skip the parent's exit handlers and static destructors
+                _exit(ReplayExitBase + static_cast<int>(result));
+            }
+            workers.emplace(pid, defect);
         }
 
-        return false;
+        while (not workers.empty() && collect());
     }
 
 };
@@ -131,6 +131,8 @@ void PredicateStateAnalysis::updateInlineSummary(llvm::Function& F) {
     // Function does not return, therefore has no useful summary
     if (not RI) return;
 
+    if (FM.restoreSummary(&F)) return;
+
     auto&& initial = delegate->getInitialState();
     auto&& riState = delegate->getInstructionState(RI);
     ASSERT(riState, "No state found for: " + slots->toString(RI));
@@ -138,7 +140,7 @@ void PredicateStateAnalysis::updateInlineSummary(llvm::Function& F) {
     auto&& bdy = riState->sliceOn(initial);
     ASSERT(bdy, "Function state slicing failed for: " + slots->toString(RI));
 
-    FM.update(&F, bdy);
+    FM.publishSummary(&F, bdy);
 }
 
 // Generate interpolation-based function summary
@@ -180,6 +182,8 @@ void PredicateStateAnalysis::updateInterpolSummary(llvm::Function& F) {
     // - function has no pointer arguments
     if (pointers.empty()) return;
 
+    if (FM.restoreSummary(&F)) return;
+
     auto&& initial = delegate->getInitialState();
     auto&& riState = delegate->getInstructionState(RI);
     ASSERT(riState, "No state found for: " + slots->toString(RI));
@@ -216,7 +220,7 @@ void PredicateStateAnalysis::updateInterpolSummary(llvm::Function& F) {
 
     auto&& summ_ = FN.State * FN.Predicate->getEqualityPredicate(summ, FN.Term->getTrueTerm());
 
-    FM.update(&F, summ_());
+    FM.publishSummary(&F, summ_());
 }
 
 void PredicateStateAnalysis::updateVisitedLocs(llvm::Function& F) {
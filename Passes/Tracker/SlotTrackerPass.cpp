@@ -6,26 +6,35 @@
  */
 
 #include "Passes/Tracker/SlotTrackerPass.h"
+#include "Statistics/statistics.h"
 #include "Util/passes.hpp"
 
 
 namespace borealis {
 
+static Statistic TrackersCreated("slot-tracker",
+    "created", "Per-function slot trackers created");
+
 bool SlotTrackerPass::doInitialization(llvm::Module&) {
     return false;
 }
 
 bool SlotTrackerPass::doFinalization(llvm::Module&) {
-    globals.reset();
+    std::lock_guard<std::mutex> lock(funcsMutex);
     funcs.clear();
+    globals.reset();
+    module = nullptr;
     return false;
 }
 
 bool SlotTrackerPass::runOnModule(llvm::Module& M) {
+    std::lock_guard<std::mutex> lock(funcsMutex);
+    funcs.clear();
     globals.reset(new SlotTracker(&M));
+    // function trackers share the module numbering, so it is done before any of them
+    globals->initialize();
+    module = &M;
     types.incorporateTypes(M);
-    for (auto& F : M)
-        funcs[&F] = ptr_t{ new SlotTracker(globals.get(), &F) };
 
     return false;
 }
@@ -35,11 +44,16 @@ void SlotTrackerPass::getAnalysisUsage(llvm::AnalysisUsage& AU) const {
 }
 
 SlotTracker* SlotTrackerPass::getSlotTracker(const llvm::Function* func) const {
-    if (func && borealis::util::containsKey(funcs, func)) {
-        return funcs.at(func).get();
-    } else {
-        return nullptr;
+    if (not func || not module || func->getParent() != module) return nullptr;
+
+    std::lock_guard<std::mutex> lock(funcsMutex);
+    auto&& tracker = funcs[func];
+    if (not tracker) {
+        tracker.reset(new SlotTracker(globals.get(), func));
+        tracker->initialize();
+        ++TrackersCreated;
     }
+    return tracker.get();
 }
 
 SlotTracker* SlotTrackerPass::getSlotTracker (const llvm::Module*) const{
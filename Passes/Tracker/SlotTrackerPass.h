@@ -10,6 +10,8 @@
 
 #include <llvm/Pass.h>
 
+#include <mutex>
+
 #include "Util/slottracker.h"
 #include "Util/ir_writer.h"
 #include "Util/util.h"
@@ -21,7 +23,13 @@ class SlotTrackerPass : public llvm::ModulePass {
     typedef std::unique_ptr<SlotTracker> ptr_t;
 
     ptr_t globals;
-    std::map<const llvm::Function*, ptr_t> funcs;
+    const llvm::Module* module = nullptr;
+    // per-function trackers are created and fully numbered on first request under the lock,
+    // so they are only read afterwards and may be shared between threads.
+    // They live until the module is done with: FactoryNest instances keep raw pointers to them,
+    // and nothing tells when the last one for a function is gone, so they are never released early
+    mutable std::map<const llvm::Function*, ptr_t> funcs;
+    mutable std::mutex funcsMutex;
     TypePrinting types;
 
 public:
@@ -70,6 +70,7 @@ bool SourceLocationTracker::runOnModule(llvm::Module& M) {
             valueDebugInfo.put(retloc, &I);
         }
     }
+    valueDebugInfo.freeze();
 
     for (auto& F : M) {
         if (F.isDeclaration()) continue;
@@ -91,6 +92,7 @@ bool SourceLocationTracker::runOnModule(llvm::Module& M) {
             }
         }
     }
+    loopDebugInfo.freeze();
 
     return false;
 }
@@ -8,8 +8,12 @@
 #ifndef SOURCE_LOCATION_TRACKER_LOCATION_CONTAINER_H
 #define SOURCE_LOCATION_TRACKER_LOCATION_CONTAINER_H
 
-#include <map>
+#include <llvm/ADT/DenseMap.h>
+
+#include <algorithm>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 #include "Util/util.h"
 
@@ -17,13 +21,23 @@
 
 namespace borealis {
 
+// Flat two-way index between locations and values.
+// Entries live in a single vector, which is sorted by location once all of them are put
+// (and again only if something is put later), so range queries are binary searches
+// over contiguous memory. Values are mapped to their entries with a dense hash table
+// for pointer keys. Filenames are interned, so comparing locations never compares strings
 template<class T>
 class location_container {
 
 public:
 
-    typedef std::multimap< Locus, T > l2t_t;
-    typedef std::unordered_map< T, Locus > t2l_t;
+    typedef std::pair< Locus, T > entry_t;
+    typedef std::vector< entry_t > l2t_t;
+    typedef std::conditional_t<
+        std::is_pointer<T>::value,
+        llvm::DenseMap< T, size_t >,
+        std::unordered_map< T, size_t >
+    > t2l_t;
 
     typedef typename l2t_t::iterator iterator;
     typedef std::pair<iterator, iterator> range;
@@ -33,23 +47,49 @@ public:
 
 private:
 
-    l2t_t l2t;
-    t2l_t t2l;
+    mutable l2t_t l2t;
+    mutable t2l_t t2l;
+    mutable bool sorted = true;
+
+    static bool byLocus(const entry_t& lhv, const entry_t& rhv) {
+        return lhv.first < rhv.first;
+    }
+
+    void sort() const {
+        if (sorted) return;
+        // stable, so that values with the same location keep the order they were put in
+        std::stable_sort(l2t.begin(), l2t.end(), byLocus);
+        for (auto i = 0U; i < l2t.size(); ++i) t2l[l2t[i].second] = i;
+        sorted = true;
+    }
+
+    const Locus& at(const T& key) const {
+        auto&& it = t2l.find(key);
+        ASSERT(it != t2l.end(), "No location for the key");
+        return l2t[it->second].first;
+    }
 
 public:
 
     void put(const Locus& loc, T val) {
-        using borealis::util::removeFromMultimap;
-
-        if (t2l.count(val)) {
-            removeFromMultimap(l2t, loc, val);
+        auto&& it = t2l.find(val);
+        if (it != t2l.end()) {
+            l2t[it->second].first = loc;
+        } else {
+            t2l[val] = l2t.size();
+            l2t.push_back({loc, val});
         }
-        t2l[val] = loc;
-        l2t.insert({loc, val});
+        sorted = false;
+    }
+
+    // sorts the index right away instead of on the first range query
+    void freeze() {
+        sort();
     }
 
     bool contains(const Locus& loc) const {
-        return l2t.count(loc) > 0;
+        sort();
+        return std::binary_search(l2t.begin(), l2t.end(), entry_t{ loc, T{} }, byLocus);
     }
 
 
@@ -63,23 +103,24 @@ public:
     }
 
     const Locus& operator[](const T& key) const {
-        return t2l.at(key);
+        return at(key);
     }
 
     template<class U, class = GUARD(util::pointers_to_same<U, T>::value)>
     const Locus& operator[](U key) const {
-        return t2l.at(const_cast<T>(key));
+        return at(const_cast<T>(key));
     }
 
     const_range range_after(const Locus& loc) const {
-        auto start = l2t.upper_bound(loc);
-        auto end = start;
-        while (end != l2t.end() && end->first == start->first) ++end;
+        sort();
+        auto start = std::upper_bound(l2t.cbegin(), l2t.cend(), entry_t{ loc, T{} }, byLocus);
+        if (start == l2t.cend()) return std::make_pair(start, start);
+        auto end = std::upper_bound(start, l2t.cend(), *start, byLocus);
         return std::make_pair(start, end);
     }
 
-    const l2t_t& getFrom() const { return l2t; }
-    const t2l_t& getTo() const { return t2l; }
+    const l2t_t& getFrom() const { sort(); return l2t; }
+    const t2l_t& getTo() const { sort(); return t2l; }
 };
 
 } // namespace borealis
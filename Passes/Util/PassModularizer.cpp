@@ -0,0 +1,156 @@
+/*
+ * PassModularizer.cpp
+ */
+
+#include <sys/resource.h>
+
+#include <algorithm>
+
+#include "Config/config.h"
+#include "Passes/Util/PassModularizer.hpp"
+#include "Statistics/statistics.h"
+#include "Util/indexed_string.hpp"
+#include "Util/passes.hpp"
+
+namespace borealis {
+namespace impl_ {
+
+static config::BoolConfigEntry ReleaseFunctionResults("analysis", "release-function-results");
+
+static Statistic ResultsReleased("modularizer",
+    "released", "Per-function results released after all their consumers");
+static Statistic PeakResults("modularizer",
+    "peak-results", "Peak number of simultaneously kept lazy per-function results");
+static Statistic PeakMemory("modularizer",
+    "peak-rss-kb", "Peak resident set size, KiB");
+static Statistic StringsReclaimed("modularizer",
+    "strings-reclaimed", "Interned strings reclaimed between functions");
+static Statistic ConsumersDeferred("modularizer",
+    "deferred", "Consumers run together function by function");
+
+ModularizerLifetimes& ModularizerLifetimes::instance() {
+    static ModularizerLifetimes instance_;
+    return instance_;
+}
+
+bool ModularizerLifetimes::enabled() {
+    static bool enabled_ = ReleaseFunctionResults.get(false);
+    return enabled_;
+}
+
+void ModularizerLifetimes::addDependency(llvm::AnalysisID consumer, llvm::AnalysisID producer) {
+    consumers[producer].insert(consumer);
+    producers[consumer].insert(producer);
+}
+
+void ModularizerLifetimes::addProducer(llvm::AnalysisID producer, Releaser releaser) {
+    releasers[producer] = releaser;
+}
+
+void ModularizerLifetimes::removeProducer(llvm::AnalysisID producer) {
+    releasers.erase(producer);
+    released.erase(producer);
+}
+
+void ModularizerLifetimes::addScheduled(llvm::AnalysisID consumer, Runner runner) {
+    scheduled[consumer] = runner;
+}
+
+void ModularizerLifetimes::removeScheduled(llvm::AnalysisID consumer) {
+    scheduled.erase(consumer);
+    deferred.erase(std::remove(deferred.begin(), deferred.end(), consumer), deferred.end());
+}
+
+bool ModularizerLifetimes::consumesLazyResults(llvm::AnalysisID consumer) const {
+    auto&& deps = producers.find(consumer);
+    if (deps == producers.end()) return false;
+    for (auto&& producer : deps->second) {
+        if (releasers.count(producer)) return true;
+    }
+    return false;
+}
+
+bool ModularizerLifetimes::defer(llvm::AnalysisID consumer, SCCPass* pass, llvm::Module& M, bool& changed) {
+    if (not enabled() || batchDone) return false;
+    if (not scheduled.count(consumer) || not consumesLazyResults(consumer)) return false;
+
+    deferred.push_back(consumer);
+    deferredBy = pass;
+    deferredModule = &M;
+
+    // the last consumer runs them all
+    for (auto&& it : scheduled) {
+        if (consumesLazyResults(it.first) && not isDeferred(it.first)) return true;
+    }
+    changed = runDeferred();
+    return true;
+}
+
+bool ModularizerLifetimes::isDeferred(llvm::AnalysisID consumer) const {
+    return std::find(deferred.begin(), deferred.end(), consumer) != deferred.end();
+}
+
+bool ModularizerLifetimes::runDeferred() {
+    if (deferred.empty()) return false;
+
+    // consumers that are not run yet will run on their own
+    batchDone = true;
+    auto&& batch = std::move(deferred);
+    deferred.clear();
+    ConsumersDeferred += batch.size();
+
+    auto* CG = &GetAnalysis<llvm::CallGraphWrapperPass>::doit(deferredBy).getCallGraph();
+    return SCCPass::forEachSCC(*deferredModule, CG, [&](const SCCPass::CallGraphSCC& SCC) {
+        bool changed = false;
+        for (auto&& consumer : batch) changed |= scheduled.at(consumer)(SCC);
+        return changed;
+    });
+}
+
+void ModularizerLifetimes::release(llvm::AnalysisID consumer, llvm::Function* F) {
+    updatePeakMemory();
+    if (enabled()) releaseResults(consumer, F);
+    // a consumer is done with a function, so strings of its dead terms can go
+    StringsReclaimed += util::indexed_string::nextGeneration();
+}
+
+void ModularizerLifetimes::releaseResults(llvm::AnalysisID consumer, llvm::Function* F) {
+    auto&& deps = producers.find(consumer);
+    if (deps == producers.end()) return;
+
+    for (auto&& producer : deps->second) {
+        auto&& releaser = releasers.find(producer);
+        if (releaser == releasers.end()) continue;
+
+        // a consumer may report the same function more than once
+        auto&& done = released[producer];
+        auto&& doneWithF = done[F];
+        doneWithF.insert(consumer);
+        if (doneWithF.size() < consumers[producer].size()) continue;
+
+        // results may be recomputed later, so the consumers should start over
+        done.erase(F);
+        releaser->second(F);
+    }
+}
+
+void ModularizerLifetimes::resultCreated() {
+    ++liveResults;
+    if (liveResults > PeakResults) PeakResults += liveResults - PeakResults;
+}
+
+void ModularizerLifetimes::resultReleased() {
+    --liveResults;
+    ++ResultsReleased;
+}
+
+void ModularizerLifetimes::updatePeakMemory() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return;
+
+    auto&& peak = static_cast<unsigned>(usage.ru_maxrss);
+    if (peak > PeakMemory) PeakMemory += peak - PeakMemory;
+}
+
+} // namespace impl_
+} // namespace borealis
@@ -10,8 +10,11 @@
 
 #include <llvm/Pass.h>
 
+#include <functional>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "Passes/Util/SCCPass.h"
 #include "Util/util.h"
@@ -21,6 +24,64 @@
 namespace borealis {
 namespace impl_ {
 
+// Tracks which modularized passes use per-function results of lazy ones,
+// so that lazy results for a function can be released as soon as
+// every consumer is done with this function.
+// Released results are recomputed if requested again.
+// The pass manager runs every pass over the whole module before the next one,
+// so consumers are deferred until the last of them is run,
+// and then they are run together SCC by SCC
+class ModularizerLifetimes {
+
+public:
+
+    typedef std::function<void(llvm::Function*)> Releaser;
+    typedef std::function<bool(const SCCPass::CallGraphSCC&)> Runner;
+
+    static ModularizerLifetimes& instance();
+    static bool enabled();
+
+    void addDependency(llvm::AnalysisID consumer, llvm::AnalysisID producer);
+    void addProducer(llvm::AnalysisID producer, Releaser releaser);
+    void removeProducer(llvm::AnalysisID producer);
+
+    void addScheduled(llvm::AnalysisID consumer, Runner runner);
+    void removeScheduled(llvm::AnalysisID consumer);
+
+    // returns true if @consumer is deferred, and should not run on its own
+    bool defer(llvm::AnalysisID consumer, SCCPass* pass, llvm::Module& M, bool& changed);
+    bool isDeferred(llvm::AnalysisID consumer) const;
+    // runs all the deferred consumers right away
+    bool runDeferred();
+
+    // @consumer will not request results for @F anymore
+    void release(llvm::AnalysisID consumer, llvm::Function* F);
+
+    void resultCreated();
+    void resultReleased();
+
+private:
+
+    ModularizerLifetimes() = default;
+
+    void releaseResults(llvm::AnalysisID consumer, llvm::Function* F);
+    void updatePeakMemory();
+    bool consumesLazyResults(llvm::AnalysisID consumer) const;
+
+    std::unordered_map<llvm::AnalysisID, std::unordered_set<llvm::AnalysisID>> consumers;
+    std::unordered_map<llvm::AnalysisID, std::unordered_set<llvm::AnalysisID>> producers;
+    std::unordered_map<llvm::AnalysisID, Releaser> releasers;
+    std::unordered_map<llvm::AnalysisID, std::unordered_map<llvm::Function*, std::unordered_set<llvm::AnalysisID>>> released;
+    size_t liveResults = 0;
+
+    std::unordered_map<llvm::AnalysisID, Runner> scheduled;
+    std::vector<llvm::AnalysisID> deferred;
+    SCCPass* deferredBy = nullptr;
+    llvm::Module* deferredModule = nullptr;
+    bool batchDone = false;
+
+};
+
 template<class SubPass, bool Lazy>
 class PassModularizerImpl : public SCCPass {
 
@@ -35,11 +96,38 @@ class PassModularizerImpl : public SCCPass {
         return std::move(res);
     }
 
+    void releaseFunction(llvm::Function* F) {
+        if (passes.erase(F) == 0) return;
+        ModularizerLifetimes::instance().resultReleased();
+        // lazy subpass does not need results of its dependencies anymore
+        ModularizerLifetimes::instance().release(&ID, F);
+    }
+
 public:
 
     static char ID;
 
-    PassModularizerImpl() : SCCPass(ID), defaultPass(new SubPass(this)) {}
+    PassModularizerImpl() : SCCPass(ID), defaultPass(new SubPass(this)) {
+        if (Lazy && ModularizerLifetimes::enabled()) {
+            ModularizerLifetimes::instance().addProducer(&ID, [this](llvm::Function* F) { releaseFunction(F); });
+        } else if (ModularizerLifetimes::enabled()) {
+            ModularizerLifetimes::instance().addScheduled(&ID, [this](const CallGraphSCC& SCC) { return runOnSCC(SCC); });
+        }
+    }
+
+    virtual ~PassModularizerImpl() {
+        if (Lazy && ModularizerLifetimes::enabled()) {
+            ModularizerLifetimes::instance().removeProducer(&ID);
+        } else if (ModularizerLifetimes::enabled()) {
+            ModularizerLifetimes::instance().removeScheduled(&ID);
+        }
+    }
+
+    virtual bool runOnModule(llvm::Module& M) {
+        bool changed = false;
+        if (not Lazy && ModularizerLifetimes::instance().defer(&ID, this, M, changed)) return changed;
+        return SCCPass::runOnModule(M);
+    }
 
     virtual bool runOnSCC(const CallGraphSCC& SCC) {
         using namespace llvm;
@@ -54,6 +142,7 @@ public:
                 subptr ptr(createSubPass(*F->getParent()));
                 changed |= ptr->runOnFunction(*F);
                 passes[F] = std::move(ptr);
+                ModularizerLifetimes::instance().release(&ID, F);
             }
         }
         return changed;
@@ -62,6 +151,12 @@ public:
     virtual void getAnalysisUsage(llvm::AnalysisUsage& AU) const {
         SCCPass::getAnalysisUsage(AU);
         defaultPass->getAnalysisUsage(AU);
+
+        if (ModularizerLifetimes::enabled()) {
+            auto& lifetimes = ModularizerLifetimes::instance();
+            for (auto&& producer : AU.getRequiredSet()) lifetimes.addDependency(&ID, producer);
+            for (auto&& producer : AU.getRequiredTransitiveSet()) lifetimes.addDependency(&ID, producer);
+        }
     }
 
     virtual void print(llvm::raw_ostream& O, const llvm::Module* M) const {
@@ -71,12 +166,18 @@ public:
     }
 
     SubPass& getResultsForFunction(llvm::Function* F) {
+        // results are requested before the deferred consumers had a chance to run
+        if (not Lazy && ModularizerLifetimes::instance().isDeferred(&ID)) {
+            ModularizerLifetimes::instance().runDeferred();
+        }
+
         if (passes.count(F) > 0) {
             return *passes[F];
         } else if (Lazy) {
             subptr ptr(createSubPass(*F->getParent()));
             ptr->runOnFunction(*F);
             passes[F] = std::move(ptr);
+            ModularizerLifetimes::instance().resultCreated();
             return *passes[F];
         } else {
             BYE_BYE(SubPass&, "Unknown function: " + F->getName().str());
@@ -41,15 +41,21 @@ void SCCPass::getAnalysisUsage(llvm::AnalysisUsage& AU) const {
 
 bool SCCPass::runOnModule(llvm::Module& M) {
     using namespace llvm;
+
+    CallGraph* CG = &GetAnalysis<CallGraphWrapperPass>::doit(this).getCallGraph();
+    return forEachSCC(M, CG, [this](const CallGraphSCC& SCC) { return runOnSCC(SCC); });
+}
+
+bool SCCPass::forEachSCC(llvm::Module& M, llvm::CallGraph* CG, const std::function<bool(const CallGraphSCC&)>& f) {
+    using namespace llvm;
     using borealis::util::view;
 
     bool changed = false;
 
     std::unordered_set<llvm::Function*> visited;
 
-    CallGraph* CG = &GetAnalysis<CallGraphWrapperPass>::doit(this).getCallGraph();
     for (auto&& SCC : view(scc_begin(CG), scc_end(CG))) {
-        changed |= runOnSCC(SCC);
+        changed |= f(SCC);
 
         util::viewContainer(SCC)
             .map(LAM(node, node->getFunction()))
@@ -60,7 +66,7 @@ bool SCCPass::runOnModule(llvm::Module& M) {
                         .map(ops::take_pointer)
                         .filter(LAM(FF, not util::contains(visited, FF)))) {
         auto&& FN = std::make_unique<CallGraphNode>(F);
-        changed |= runOnSCC(CallGraphSCC{FN.get()});
+        changed |= f(CallGraphSCC{FN.get()});
     }
 
     return changed;
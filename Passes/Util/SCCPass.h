@@ -11,6 +11,7 @@
 #include <llvm/Analysis/CallGraph.h>
 #include <llvm/Pass.h>
 
+#include <functional>
 #include <vector>
 
 namespace borealis {
@@ -28,6 +29,9 @@ public:
     virtual ~SCCPass();
 
     virtual bool runOnSCC(const CallGraphSCC& SCC) = 0;
+
+    // calls @f for every SCC of @CG bottom-up, then for every function of @M not in @CG
+    static bool forEachSCC(llvm::Module& M, llvm::CallGraph* CG, const std::function<bool(const CallGraphSCC&)>& f);
 };
 
 } /* namespace borealis */
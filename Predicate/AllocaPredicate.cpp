@@ -16,13 +16,16 @@ AllocaPredicate::AllocaPredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
-    asString = lhv->getName() + "=alloca(" +
-        numElements->getName() + "," +
-        origNumElements->getName() +
-    ")";
     ops = { lhv, numElements, origNumElements };
 }
 
+std::string AllocaPredicate::render() const {
+    return getLhv()->getName() + "=alloca(" +
+        getNumElems()->getName() + "," +
+        getOrigNumElems()->getName() +
+    ")";
+}
+
 Term::Ptr AllocaPredicate::getLhv() const {
     return ops[0];
 }
@@ -19,13 +19,16 @@ CallPredicate::CallPredicate(
     if (hasLhv_) ops.insert(ops.end(), lhv);
     ops.insert(ops.end(), function);
     ops.insert(ops.end(), args.begin(), args.end());
+}
 
-    asString = "";
+std::string CallPredicate::render() const {
+    std::string res = "";
     if(hasLhv())
-        asString = getLhv()->getName() + "=";
-    asString += getFunctionName()->getName() + "(" + getArgs()
-                                                     .map(LAM(a, a->getName()))
-                                                     .reduce("", LAM2(acc, e, acc + ", " + e)) + ")";
+        res = getLhv()->getName() + "=";
+    res += getFunctionName()->getName() + "(" + getArgs()
+                                                .map(LAM(a, a->getName()))
+                                                .reduce("", LAM2(acc, e, acc + ", " + e)) + ")";
+    return res;
 }
 
 bool CallPredicate::hasLhv() const {
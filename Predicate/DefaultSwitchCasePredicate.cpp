@@ -17,15 +17,16 @@ DefaultSwitchCasePredicate::DefaultSwitchCasePredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
+    ops.insert(ops.end(), cond);
+    ops.insert(ops.end(), cases.begin(), cases.end());
+}
 
-    auto&& a = util::viewContainer(cases)
+std::string DefaultSwitchCasePredicate::render() const {
+    auto&& a = getCases()
                 .map([](auto&& c) { return c->getName(); })
                 .reduce("", [](auto&& acc, auto&& e) { return acc + "|" + e; });
 
-    asString = cond->getName() + "=not(" + a + ")";
-
-    ops.insert(ops.end(), cond);
-    ops.insert(ops.end(), cases.begin(), cases.end());
+    return getCond()->getName() + "=not(" + a + ")";
 }
 
 Term::Ptr DefaultSwitchCasePredicate::getCond() const {
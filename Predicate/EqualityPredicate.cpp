@@ -15,10 +15,13 @@ EqualityPredicate::EqualityPredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
-    asString = lhv->getName() + "=" + rhv->getName();
     ops = { lhv, rhv };
 }
 
+std::string EqualityPredicate::render() const {
+    return getLhv()->getName() + "=" + getRhv()->getName();
+}
+
 Term::Ptr EqualityPredicate::getLhv() const {
     return ops[0];
 }
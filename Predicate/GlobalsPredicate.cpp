@@ -14,14 +14,15 @@ GlobalsPredicate::GlobalsPredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
+    ops.insert(ops.end(), globals.begin(), globals.end());
+}
 
-    auto&& a = util::viewContainer(globals)
+std::string GlobalsPredicate::render() const {
+    auto&& a = getGlobals()
                 .map([](auto&& g) { return g->getName(); })
                 .reduce("", [](auto&& acc, auto&& e) { return acc + "," + e; });
 
-    asString = "globals(" + a + ")";
-
-    ops.insert(ops.end(), globals.begin(), globals.end());
+    return "globals(" + a + ")";
 }
 
 auto GlobalsPredicate::getGlobals() const -> decltype(util::viewContainer(ops)) {
@@ -15,10 +15,13 @@ InequalityPredicate::InequalityPredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
-    asString = lhv->getName() + "!=" + rhv->getName();
     ops = { lhv, rhv };
 }
 
+std::string InequalityPredicate::render() const {
+    return getLhv()->getName() + "!=" + getRhv()->getName();
+}
+
 Term::Ptr InequalityPredicate::getLhv() const {
     return ops[0];
 }
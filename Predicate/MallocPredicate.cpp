@@ -16,13 +16,16 @@ MallocPredicate::MallocPredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
-    asString = lhv->getName() + "=malloc(" +
-        numElems->getName() + "," +
-        origNumElems->getName() +
-    ")";
     ops = { lhv, numElems, origNumElems };
 }
 
+std::string MallocPredicate::render() const {
+    return getLhv()->getName() + "=malloc(" +
+        getNumElems()->getName() + "," +
+        getOrigNumElems()->getName() +
+    ")";
+}
+
 Term::Ptr MallocPredicate::getLhv() const {
     return ops[0];
 }
@@ -9,10 +9,13 @@ MarkPredicate::MarkPredicate(
     const Locus& loc,
     PredicateType type) :
     Predicate(class_tag(*this), type, loc) {
-    asString = tfm::format("mark(%s)", id->getName());
     ops = { id };
 }
 
+std::string MarkPredicate::render() const {
+    return tfm::format("mark(%s)", getId()->getName());
+}
+
 Term::Ptr MarkPredicate::getId() const {
     return ops.front();
 }
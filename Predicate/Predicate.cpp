@@ -5,11 +5,16 @@
  *      Author: ice-phoenix
  */
 
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+
 #include "Annotation/AssertAnnotation.h"
 #include "Annotation/AssumeAnnotation.h"
 #include "Annotation/EnsuresAnnotation.h"
 #include "Annotation/GlobalAnnotation.h"
 #include "Annotation/RequiresAnnotation.h"
+#include "Config/config.h"
 #include "Predicate/Predicate.h"
 
 #include "Statistics/statistics.h"
@@ -19,6 +24,64 @@
 namespace borealis {
 
 static Statistic totalPredicatesCreated("misc", "totalPredicates", "Total number of predicates created");
+static Statistic predicatesRendered("misc", "renderedPredicates", "Total number of predicates rendered to strings");
+
+static config::IntConfigEntry StringCacheSize("logging", "predicate-string-cache");
+
+namespace {
+
+// Bounded LRU cache of predicate renderings.
+// Entries are dropped when their predicates die, so addresses are never reused by mistake
+class RenderCache {
+
+    using Entries = std::list<std::pair<const Predicate*, std::string>>;
+
+    size_t capacity;
+    Entries entries;
+    std::unordered_map<const Predicate*, Entries::iterator> index;
+
+public:
+
+    RenderCache(size_t capacity): capacity(capacity) {}
+
+    static RenderCache& instance() {
+        // never destroyed, as predicates may outlive any static
+        static auto&& instance_ = new RenderCache(std::max(StringCacheSize.get(0), 0));
+        return *instance_;
+    }
+
+    template<class Render>
+    const std::string& get(const Predicate* pred, Render&& render) {
+        auto&& it = index.find(pred);
+        if (it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+
+        if (entries.size() == capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(pred, render());
+        index[pred] = entries.begin();
+        return entries.front().second;
+    }
+
+    void forget(const Predicate* pred) {
+        if (index.empty()) return;
+        auto&& it = index.find(pred);
+        if (it == index.end()) return;
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    bool enabled() const {
+        return capacity > 0;
+    }
+
+};
+
+} // namespace
 
 PredicateType predicateType(const Annotation* a) {
    using namespace llvm;
@@ -66,7 +129,19 @@ const Predicate::Operands& Predicate::getOperands() const {
     return ops;
 }
 
+Predicate::~Predicate() {
+    RenderCache::instance().forget(this);
+}
+
+std::string Predicate::render() const {
+    return "";
+}
+
 std::string Predicate::toString() const {
+   auto&& cache = RenderCache::instance();
+   auto&& doRender = [this]() { ++predicatesRendered; return render(); };
+   auto&& asString = cache.enabled() ? cache.get(this, doRender) : doRender();
+
    switch (type) {
    case PredicateType::REQUIRES:  return "@R " + asString;
    case PredicateType::ENSURES:   return "@E " + asString;
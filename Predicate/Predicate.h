@@ -85,7 +85,7 @@ protected:
 
 public:
 
-    virtual ~Predicate() = default;
+    virtual ~Predicate();
 
     PredicateType getType() const;
     Predicate* setType(PredicateType type);
@@ -109,11 +109,13 @@ public:
 
 protected:
 
+    // Renders the predicate without its type, subclasses should override this.
+    // Called on demand only, the result may be kept in a bounded cache
+    virtual std::string render() const;
+
     PredicateType type;
     Locus location;
 
-    // Must be set in subclasses
-    std::string asString;
     Operands ops;
 
 };
@@ -177,6 +179,7 @@ struct hash<const borealis::PredicateType> : public borealis::util::enums::enum_
 private: \
     using Self = CLASS; \
     CLASS(const Self&) = default; \
+    virtual std::string render() const override; \
 public: \
     friend class PredicateFactory; \
     friend struct protobuf_traits_impl<CLASS>; \
@@ -15,14 +15,16 @@ SeqDataPredicate::SeqDataPredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
-    auto&& a = util::viewContainer(data)
+    ops.insert(ops.end(), base);
+    ops.insert(ops.end(), data.begin(), data.end());
+}
+
+std::string SeqDataPredicate::render() const {
+    auto&& a = getData()
                 .map([](auto&& d) { return d->getName(); })
                 .reduce("", [](auto&& acc, auto&& e) { return acc + "," + e; });
 
-    asString = base->getName() + "=(" + a + ")";
-
-    ops.insert(ops.end(), base);
-    ops.insert(ops.end(), data.begin(), data.end());
+    return getBase()->getName() + "=(" + a + ")";
 }
 
 Term::Ptr SeqDataPredicate::getBase() const {
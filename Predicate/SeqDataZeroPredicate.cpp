@@ -15,12 +15,13 @@ SeqDataZeroPredicate::SeqDataZeroPredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc), size(size) {
-
-    asString = base->getName() + "=(0 x " + util::toString(size) + ")";
-
     ops.insert(ops.end(), base);
 }
 
+std::string SeqDataZeroPredicate::render() const {
+    return getBase()->getName() + "=(0 x " + util::toString(size) + ")";
+}
+
 Term::Ptr SeqDataZeroPredicate::getBase() const {
     return ops[0];
 }
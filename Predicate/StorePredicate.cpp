@@ -15,10 +15,13 @@ StorePredicate::StorePredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
-    asString = "*" + lhv->getName() + "=" + rhv->getName();
     ops = { lhv, rhv };
 }
 
+std::string StorePredicate::render() const {
+    return "*" + getLhv()->getName() + "=" + getRhv()->getName();
+}
+
 Term::Ptr StorePredicate::getLhv() const {
     return ops[0];
 }
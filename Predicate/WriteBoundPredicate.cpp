@@ -15,13 +15,16 @@ WriteBoundPredicate::WriteBoundPredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
-    asString = "writeBound(" +
-        lhv->getName() + "," +
-        rhv->getName() +
-    ")";
     ops = { lhv, rhv };
 }
 
+std::string WriteBoundPredicate::render() const {
+    return "writeBound(" +
+        getLhv()->getName() + "," +
+        getRhv()->getName() +
+    ")";
+}
+
 Term::Ptr WriteBoundPredicate::getLhv() const {
     return ops[0];
 }
@@ -16,14 +16,17 @@ WritePropertyPredicate::WritePropertyPredicate(
         const Locus& loc,
         PredicateType type) :
             Predicate(class_tag(*this), type, loc) {
-    asString = "write(" +
-        propName->getName() + "," +
-        lhv->getName() + "," +
-        rhv->getName() +
-    ")";
     ops = { lhv, rhv, propName };
 }
 
+std::string WritePropertyPredicate::render() const {
+    return "write(" +
+        getPropertyName()->getName() + "," +
+        getLhv()->getName() + "," +
+        getRhv()->getName() +
+    ")";
+}
+
 Term::Ptr WritePropertyPredicate::getLhv() const {
     return ops[0];
 }
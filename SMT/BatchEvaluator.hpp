@@ -0,0 +1,107 @@
+/*
+ * BatchEvaluator.hpp
+ */
+
+#ifndef BOREALIS_SMT_BATCHEVALUATOR_HPP_
+#define BOREALIS_SMT_BATCHEVALUATOR_HPP_
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include "Factory/Nest.h"
+#include "SMT/SMT.hpp"
+#include "Term/TermUtils.hpp"
+
+#include "Util/macros.h"
+
+namespace borealis {
+
+// Evaluates a whole set of predicates against a single model.
+// Every predicate is translated once, and their values are packed as bits of
+// BatchWidth-wide bitvectors, so the model is consulted once per BatchWidth predicates
+// and subterms shared between them are evaluated only once
+template<class Impl>
+class BatchEvaluator {
+
+    USING_SMT_IMPL(Impl);
+
+    FactoryNest FN;
+    ExprFactory& ef;
+    ExecutionContext& ctx;
+
+public:
+
+    static constexpr size_t BatchWidth = 32;
+
+    BatchEvaluator(const FactoryNest& FN, ExprFactory& ef, ExecutionContext& ctx): FN(FN), ef(ef), ctx(ctx) {}
+
+    // @eval(packed, witness) evaluates @packed in the model and turns the result into a constant term,
+    // predicates that cannot be evaluated (e.g. over variables the model does not assign) are considered false
+    template<class Eval>
+    std::vector<bool> evaluate(const std::vector<Predicate::Ptr>& preds, Eval&& eval) {
+        std::vector<bool> result(preds.size(), false);
+
+        auto&& witness = FN.Term->getIntTerm(0, BatchWidth);
+        auto zero = DynBV::mkConst(ef.unwrap(), 0, BatchWidth);
+
+        auto one = DynBV::mkConst(ef.unwrap(), 1, BatchWidth);
+
+        for (auto batch = 0U; batch < preds.size(); batch += BatchWidth) {
+            DynBV packed = zero;
+            std::vector<Bool> axioms;
+            auto size = std::min(BatchWidth, preds.size() - batch);
+            for (auto i = 0U; i < size; ++i) {
+                auto&& p = SMT<Impl>::doit(preds[batch + i], ef, &ctx);
+                axioms.push_back(Bool{ ef.unwrap(), p.asAxiom() });
+                auto&& bit = DynBV::mkConst(ef.unwrap(), int64_t(1) << i, BatchWidth);
+                packed = packed | if_(axioms.back()).then_(bit).else_(zero);
+            }
+
+            auto&& bits = TermUtils::getUIntegerValue(eval(packed, witness));
+            if (bits) {
+                for (auto i = 0U; i < size; ++i) {
+                    result[batch + i] = (bits.getUnsafe() >> i) & 1;
+                }
+                continue;
+            }
+
+            // some predicate of the batch has no value in the model,
+            // so the batch is evaluated one predicate at a time, leaving out only those
+            for (auto i = 0U; i < size; ++i) {
+                auto&& bit = TermUtils::getUIntegerValue(eval(if_(axioms[i]).then_(one).else_(zero), witness));
+                result[batch + i] = bit and bit.getUnsafe() == 1;
+            }
+        }
+
+        return std::move(result);
+    }
+
+    // returns the predicates of type PATH in @state that hold in the model
+    template<class Eval>
+    PredicateState::Ptr filterPath(PredicateState::Ptr state, Eval&& eval) {
+        auto&& path = state->filterByTypes({PredicateType::PATH});
+
+        std::vector<Predicate::Ptr> preds;
+        path->filter([&](auto&& p) { preds.push_back(p); return true; });
+
+        auto&& values = evaluate(preds, std::forward<Eval>(eval));
+
+        std::unordered_set<Predicate::Ptr> valid;
+        for (auto i = 0U; i < preds.size(); ++i) {
+            if (values[i]) valid.insert(preds[i]);
+        }
+
+        return path->filter([&](auto&& p) { return valid.count(p) > 0; });
+    }
+
+};
+
+template<class Impl>
+constexpr size_t BatchEvaluator<Impl>::BatchWidth;
+
+} // namespace borealis
+
+#include "Util/unmacros.h"
+
+#endif /* BOREALIS_SMT_BATCHEVALUATOR_HPP_ */
@@ -44,13 +44,10 @@ static std::unordered_set<boolectorpp::node, std::hash<boolectorpp::node>, Boole
     return std::move(ret);
 }
 
-Solver::check_result Solver::check(
-        const Bool& query,
+void Solver::assertState(
         const Bool& state,
         const ExecutionContext& ctx) {
 
-    using namespace logic;
-
     TRACE_FUNC;
 
     auto&& bctx = bef.unwrap();
@@ -65,15 +62,10 @@ Solver::check_result Solver::check(
     boolector_assert(bctx, state.asAxiom());
     dbgs() << "! adding axioms finished" << endl;
 
-    dbgs() << "! adding query started" << endl;
-    boolector_assert(bctx, query.getAxiom());
-    dbgs() << "! adding query finished" << endl;
-
     if (log_formulae.get(false)) {
         dbgs() << "! printing stuff started" << endl;
 
         auto&& dbg = dbgs();
-        dbg << "  Query: " << endl << query << endl;
         dbg << "  State: " << endl << state << endl;
         dbg << "  Axioms: " << endl;
 
@@ -84,6 +76,28 @@ Solver::check_result Solver::check(
 
         dbgs() << "! printing stuff finished" << endl;
     }
+}
+
+Solver::check_result Solver::check(
+        const Bool& query,
+        const Bool& state,
+        const ExecutionContext& ctx) {
+
+    using namespace logic;
+
+    TRACE_FUNC;
+
+    auto&& bctx = bef.unwrap();
+
+    assertState(state, ctx);
+
+    dbgs() << "! adding query started" << endl;
+    boolector_assert(bctx, query.getAxiom());
+    dbgs() << "! adding query finished" << endl;
+
+    if (log_formulae.get(false)) {
+        dbgs() << "  Query: " << endl << query << endl;
+    }
 
     boolector_assert(bctx, query.getExpr());
     {
@@ -300,6 +314,86 @@ Result Solver::isViolated(
     return UnsatResult{};
 }
 
+std::vector<Result> Solver::isViolated(
+        const std::vector<PredicateState::Ptr>& queries,
+        PredicateState::Ptr state) {
+
+    using namespace logic;
+
+    TRACE_FUNC;
+
+    dbgs() << "Checking " << queries.size() << " queries in a batch" << endl;
+
+    ExecutionContext ctx{ bef, memoryStart, memoryEnd };
+    dbgs() << "! state conversion started" << endl;
+    auto&& smtstate = SMT<Boolector>::doit(state, bef, &ctx);
+    dbgs() << "! state conversion finished" << endl;
+
+    std::vector<Bool> smtqueries;
+    smtqueries.reserve(queries.size());
+    for (auto&& query : queries) {
+        smtqueries.push_back(not SMT<Boolector>::doit(query, bef, &ctx));
+    }
+
+    auto&& bctx = bef.unwrap();
+    boolector_set_opt(bctx, "incremental", 1);
+
+    // the same setup as for a single query, only every query is guarded by its own literal
+    assertState(smtstate, ctx);
+
+    std::vector<Bool> literals;
+    literals.reserve(queries.size());
+    for (auto i = 0U; i < queries.size(); ++i) {
+        auto&& literal = bef.getBoolVar(tfm::format("$CHECK$%d", i));
+        boolector_assert(bctx, smtqueries[i].getAxiom());
+        boolector_assert(bctx, literal.implies(smtqueries[i]).getExpr());
+        literals.push_back(literal);
+        if (log_formulae.get(false)) {
+            dbgs() << "  Query " << i << ": " << endl << smtqueries[i] << endl;
+        }
+    }
+
+    std::vector<Result> results;
+    results.reserve(queries.size());
+    for (auto i = 0U; i < queries.size(); ++i) {
+        int res;
+        {
+            TRACE_BLOCK("boolector::check");
+            // assumptions hold for the next call to boolector_sat only
+            boolector_assume(bctx, literals[i].getExpr());
+            res = boolector_sat(bctx);
+        }
+        dbgs() << "Acquired result for query " << i << ": "
+               << (res == BOOLECTOR_SAT? "sat" : (res == BOOLECTOR_UNSAT) ? "unsat" : "unknown")
+               << endl;
+
+        if (res != BOOLECTOR_SAT) {
+            results.push_back(UnsatResult{});
+            continue;
+        }
+
+        // the model belongs to the last call to boolector_sat, so it is collected right away
+        if (gather_boolector_models.get(false) or gather_smt_models.get(false)) {
+            FactoryNest FN;
+            auto&& vars = collectVariables(FN, queries[i], state);
+            auto&& pointers = collectPointers(FN, queries[i], state);
+            auto&& props = collectPropertyTargets(FN, queries[i], state);
+
+            auto&& model = std::make_shared<Model>(FN);
+
+            model->getAssignments() = recollectModel(FN, bef, ctx, bctx, vars);
+            recollectMemory(*model, bef, ctx, bctx, pointers);
+            recollectProperties(*model, bef, ctx, bctx, props);
+
+            results.push_back(SatResult{model});
+        } else {
+            results.push_back(SatResult{});
+        }
+    }
+
+    return results;
+}
+
 void Solver::interrupt() {
 }
 
@@ -36,6 +36,12 @@ public:
             PredicateState::Ptr query,
             PredicateState::Ptr state);
 
+    // checks every query against the same state: the state is asserted once,
+    // and each query is enabled by its own assumption literal
+    std::vector<smt::Result> isViolated(
+            const std::vector<PredicateState::Ptr>& queries,
+            PredicateState::Ptr state);
+
     smt::Result isPathImpossible(
             PredicateState::Ptr path,
             PredicateState::Ptr state);
@@ -51,6 +57,11 @@ private:
 
     using check_result = std::tuple<int, boolectorpp::context*, util::option<int>, util::option<int>>;
 
+    // asserts @state together with the axioms of @ctx
+    void assertState(
+        const Bool& state,
+        const ExecutionContext& ctx);
+
     check_result check(
         const Bool& query,
         const Bool& state,
@@ -15,6 +15,7 @@
 #include "State/Transformer/PointerCollector.h"
 #include "State/Transformer/VariableCollector.h"
 #include "SMT/CVC4/Logic.hpp"
+#include "SMT/QueryTimeout.h"
 #include "SMT/CVC4/Unlogic/Unlogic.h"
 #include "SMT/CVC4/Solver.h"
 #include "SMT/CVC4/CVC4.h"
@@ -70,7 +71,8 @@ Solver::check_result Solver::check(
     s->setOption("output-language", "smt2");
     s->setOption("interactive-mode", true);
 
-    for(auto&& tl : force_timeout.get()) s->setTimeLimit(tl);
+    auto timeLimit = QueryTimeout::apply(force_timeout.get(0));
+    if (timeLimit > 0) s->setTimeLimit(timeLimit);
 
     auto&& axioms = uniqueAxioms(ctx);
 
@@ -55,7 +55,7 @@ public:
     ////////////////////////////////////////////////////////////////////////////
     // Pointers
     Pointer getPtrVar(const std::string& name, bool fresh = false);
-    Pointer getPtrConst(int ptr);
+    Pointer getPtrConst(unsigned long long ptr);
     Pointer getNullPtr();
     // Bools
     Bool getBoolVar(const std::string& name, bool fresh = false);
@@ -64,7 +64,7 @@ public:
     Bool getFalse();
     // Integers
     Integer getIntVar(const std::string& name, unsigned int size = Byte::bitsize, bool fresh = false);
-    Integer getIntConst(int v, unsigned int size = Byte::bitsize);
+    Integer getIntConst(long long v, unsigned int size = Byte::bitsize);
     Integer getIntConst(const std::string& v, unsigned int size = Byte::bitsize);
     // Reals
     Real getRealVar(const std::string& name, bool fresh = false);
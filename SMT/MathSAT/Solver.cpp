@@ -7,6 +7,7 @@
 
 #include "State/Transformer/VariableCollector.h"
 #include "Logging/tracer.hpp"
+#include "SMT/BatchEvaluator.hpp"
 #include "SMT/MathSAT/Solver.h"
 #include "SMT/MathSAT/Unlogic/Unlogic.h"
 #include "SMT/Z3/Solver.h"
@@ -121,14 +122,10 @@ smt::Result Solver::isViolated(
     if (res == MSAT_SAT) {
         auto&& m = model.getUnsafe(); // You shall not fail! (c)
 
-        auto&& cex = state
-            ->filterByTypes({PredicateType::PATH})
-            ->filter([&](auto&& p) {
-                auto&& msatp = SMT<MathSAT>::doit(p, msatef, &ctx);
-                auto&& valid = m.eval(msatp.asAxiom());
-                auto&& bValid = util::stringCast<bool>(valid);
-                return bValid.getOrElse(false);
-            });
+        FactoryNest FN;
+        auto&& cex = BatchEvaluator<MathSAT>(FN, msatef, ctx).filterPath(state, [&](auto&& packed, auto&&) {
+            return unlogic::undoThat(Dynamic(msatef.unwrap(), m.eval(packed.getExpr())));
+        });
 
         using namespace logging;
         dbgs() << "CEX: "
@@ -21,10 +21,62 @@ static Term::Ptr getOrUndef(const FactoryNest&, const Model::assignments_t& map,
     return nullptr;
 }
 
+void Model::setEvaluator(std::shared_ptr<Evaluator> ev, const term_set_t& vars, const term_set_t& ptrs) {
+    evaluator = ev;
+    pendingVars = vars;
+    pendingPointers = ptrs;
+}
+
+void Model::materializeVar(Term::Ptr var) const {
+    if(not evaluator) return;
+
+    auto&& it = pendingVars.find(var);
+    if(it == pendingVars.end()) return;
+
+    assignments[*it] = evaluator->evaluate(*it);
+    pendingVars.erase(it);
+}
+
+void Model::materializePointer(Term::Ptr ptr) const {
+    if(not evaluator) return;
+
+    if(evaluatedPointers.count(ptr)) return;
+
+    auto&& it = pendingPointers.find(ptr);
+    if(it == pendingPointers.end()) {
+        // memory shapes are keyed by pointer values, and some other pointer may have the same one
+        materializeMemory();
+        return;
+    }
+
+    evaluator->evaluateMemory(const_cast<Model&>(*this), *it);
+    evaluatedPointers.insert(*it);
+    pendingPointers.erase(it);
+}
+
+void Model::materializeMemory() const {
+    if(not evaluator) return;
+
+    for(auto&& ptr : pendingPointers) evaluator->evaluateMemory(const_cast<Model&>(*this), ptr);
+    evaluatedPointers.insert(pendingPointers.begin(), pendingPointers.end());
+    pendingPointers.clear();
+}
+
+void Model::materialize() const {
+    if(not evaluator) return;
+
+    for(auto&& var : pendingVars) assignments[var] = evaluator->evaluate(var);
+    pendingVars.clear();
+    materializeMemory();
+    evaluatedPointers.clear();
+    evaluator.reset();
+}
+
 Term::Ptr Model::query(Term::Ptr t) const {
     if(TermUtils::isConstantTerm(t)) return t;
 
     if(TermUtils::isNamedTerm(t)) {
+        materializeVar(t);
         return getOrUndef(FN, assignments, t);
     }
 
@@ -35,6 +87,7 @@ Term::Ptr Model::query(Term::Ptr t) const {
 
     if(auto&& load = llvm::dyn_cast<LoadTerm>(t)) {
         auto&& ptr = load->getRhv();
+        materializePointer(ptr);
         auto&& reptr = TermUtils::stripCasts(query(ptr));
 
         size_t memspace = 0;
@@ -51,6 +104,7 @@ Term::Ptr Model::query(Term::Ptr t) const {
 
     if(auto&& bd = llvm::dyn_cast<BoundTerm>(t)) {
         auto&& ptr = TermUtils::stripCasts(bd->getRhv());
+        materializePointer(ptr);
         auto&& reptr = TermUtils::stripCasts(query(ptr));
 
         size_t memspace = 0;
@@ -68,6 +122,7 @@ Term::Ptr Model::query(Term::Ptr t) const {
     if(auto&& rp = llvm::dyn_cast<ReadPropertyTerm>(t)) {
         auto&& ptr = TermUtils::stripCasts(rp->getRhv());
         auto&& prop = rp->getPropertyName()->getName();
+        materializePointer(ptr);
 
         auto&& reptr = TermUtils::stripCasts(query(ptr));
 
@@ -83,6 +138,8 @@ Term::Ptr Model::query(Term::Ptr t) const {
 }
 
 Term::Ptr Model::adjust(Term::Ptr t) const {
+    materialize();
+
     struct Adjuster: Transformer<Adjuster> {
         using Base = Transformer<Adjuster>;
 
@@ -5,6 +5,9 @@
 #ifndef SMT_MODEL_H
 #define SMT_MODEL_H
 
+#include <memory>
+#include <unordered_set>
+
 #include "Term/Term.h"
 #include "Factory/Nest.h"
 
@@ -82,18 +85,40 @@ public:
     using assignments_t = std::unordered_map<Term::Ptr, Term::Ptr, TermHash, TermEquals>;
     using memory_spaces_t = std::unordered_map<size_t, MemoryShape>;
     using property_spaces_t = std::unordered_map<std::string, MemoryShape>;
+    using term_set_t = std::unordered_set<Term::Ptr, TermHash, TermEquals>;
+
+    // Backend-specific wrapper around a native solver model.
+    // Lazy models keep one and ask it for values on first request only
+    class Evaluator {
+    public:
+        virtual ~Evaluator() = default;
+        // value of a single variable
+        virtual Term::Ptr evaluate(Term::Ptr var) = 0;
+        // fills in memory, bound and property shapes of @model for a single pointer
+        virtual void evaluateMemory(Model& model, Term::Ptr ptr) = 0;
+    };
 
 private:
     FactoryNest FN;
-    assignments_t assignments;
-    memory_spaces_t memories;
-    memory_spaces_t bounds;
-    property_spaces_t properties;
-
-    const assignments_t& getAssignments() const { return assignments; }
-    const memory_spaces_t& getMemories() const { return memories; }
-    const memory_spaces_t& getBounds() const { return bounds; }
-    const property_spaces_t& getProperties() const { return properties; }
+    // all of these are caches for lazy models, so they can be filled in from const methods
+    mutable assignments_t assignments;
+    mutable memory_spaces_t memories;
+    mutable memory_spaces_t bounds;
+    mutable property_spaces_t properties;
+
+    mutable std::shared_ptr<Evaluator> evaluator;
+    mutable term_set_t pendingVars;
+    mutable term_set_t pendingPointers;
+    mutable term_set_t evaluatedPointers;
+
+    const assignments_t& getAssignments() const { materialize(); return assignments; }
+    const memory_spaces_t& getMemories() const { materialize(); return memories; }
+    const memory_spaces_t& getBounds() const { materialize(); return bounds; }
+    const property_spaces_t& getProperties() const { materialize(); return properties; }
+
+    void materializeVar(Term::Ptr var) const;
+    void materializePointer(Term::Ptr ptr) const;
+    void materializeMemory() const;
 
     friend struct protobuf_traits<Model>;
 
@@ -107,11 +132,19 @@ public:
 
     const FactoryNest& getFactoryNest() const { return FN; }
 
+    // makes the model lazy: @vars and @ptrs are evaluated by @ev on first request
+    void setEvaluator(std::shared_ptr<Evaluator> ev, const term_set_t& vars, const term_set_t& ptrs);
+    bool isLazy() const { return static_cast<bool>(evaluator); }
+    // evaluates everything still pending and drops the native model,
+    // must be called before the solver context is destroyed
+    void materialize() const;
+
     Term::Ptr query(Term::Ptr) const;
 
     Term::Ptr adjust(Term::Ptr) const;
 
     friend std::ostream& operator<<(std::ostream& ost, const Model& model) {
+        model.materialize();
         ost << "model: {";
         for(auto&& ass: model.assignments) {
             ost << tfm::format("\n    %s = %s", ass.first, ass.second);
@@ -10,6 +10,7 @@
 #include "SMT/STP/Solver.h"
 #include "SMT/MathSAT/Solver.h"
 #include "SMT/ProtobufConverterImpl.hpp"
+#include "SMT/QueryTimeout.h"
 #include "State/Transformer/GraphBuilder.h"
 
 #include <chrono>
@@ -221,7 +222,7 @@ smt::Result Solver::isViolated(PredicateState::Ptr query, PredicateState::Ptr st
         while(wait(nullptr) != -1);
     )
 
-    auto timeout = std::chrono::milliseconds(force_timeout.get(0));
+    auto timeout = std::chrono::milliseconds(smt::QueryTimeout::apply(force_timeout.get(0)));
     auto startTime = std::chrono::steady_clock::now();
 
     std::unordered_set<fd_t> files;
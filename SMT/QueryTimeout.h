@@ -0,0 +1,51 @@
+/*
+ * QueryTimeout.h
+ */
+
+#ifndef SMT_QUERYTIMEOUT_H_
+#define SMT_QUERYTIMEOUT_H_
+
+#include <algorithm>
+
+namespace borealis {
+namespace smt {
+
+// Timeout (in milliseconds) for the queries solved while the scope is alive,
+// set by whoever schedules the queries.
+// Solvers still honor their own force-timeout, whichever is shorter wins
+class QueryTimeout {
+
+    unsigned previous;
+
+    static unsigned& current() {
+        static unsigned instance = 0U;
+        return instance;
+    }
+
+public:
+
+    explicit QueryTimeout(unsigned timeout): previous(current()) {
+        current() = timeout;
+    }
+
+    ~QueryTimeout() {
+        current() = previous;
+    }
+
+    QueryTimeout(const QueryTimeout&) = delete;
+    QueryTimeout& operator=(const QueryTimeout&) = delete;
+
+    // 0 means no timeout for both @configured and the result
+    static unsigned apply(unsigned configured) {
+        auto scheduled = current();
+        if (scheduled == 0U) return configured;
+        if (configured == 0U) return scheduled;
+        return std::min(configured, scheduled);
+    }
+
+};
+
+} /* namespace smt */
+} /* namespace borealis */
+
+#endif /* SMT_QUERYTIMEOUT_H_ */
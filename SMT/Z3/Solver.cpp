@@ -14,8 +14,10 @@
 #include "State/PredicateStateBuilder.h"
 #include "State/Transformer/PointerCollector.h"
 #include "State/Transformer/VariableCollector.h"
+#include "SMT/BatchEvaluator.hpp"
 #include "SMT/Z3/Divers.h"
 #include "SMT/Z3/Logic.hpp"
+#include "SMT/QueryTimeout.h"
 #include "SMT/Z3/Solver.h"
 #include "SMT/Z3/Tactics.h"
 #include "SMT/Z3/Unlogic/Unlogic.h"
@@ -39,12 +41,16 @@ static borealis::config::StringConfigEntry dump_unknown_smt2_state{ "output", "d
 
 static config::BoolConfigEntry gather_smt_models("analysis", "collect-models");
 static config::BoolConfigEntry gather_z3_models("analysis", "collect-z3-models");
+static config::BoolConfigEntry lazy_models("analysis", "lazy-models");
 
 static config::BoolConfigEntry sanity_check("analysis", "sanity-check");
 static config::IntConfigEntry sanity_check_timeout("analysis", "sanity-check-timeout");
 
 Solver::Solver(ExprFactory& z3ef, unsigned long long memoryStart, unsigned long long memoryEnd) :
-        z3ef(z3ef), memoryStart(memoryStart), memoryEnd(memoryEnd) {}
+        z3ef(z3ef), z3efOwner(nullptr), memoryStart(memoryStart), memoryEnd(memoryEnd) {}
+
+Solver::Solver(std::shared_ptr<ExprFactory> z3ef, unsigned long long memoryStart, unsigned long long memoryEnd) :
+        z3ef(*z3ef), z3efOwner(z3ef), memoryStart(memoryStart), memoryEnd(memoryEnd) {}
 
 z3::tactic Solver::tactics(unsigned int timeout) {
     auto&& c = z3ef.unwrap();
@@ -66,6 +72,21 @@ static std::unordered_set<z3::expr, std::hash<z3::expr>, Z3Engine::equality> uni
     return std::move(ret);
 }
 
+static void dumpSolver(z3::solver& s, const util::option<std::string>& dump_dir) {
+    if (not dump_dir) return;
+
+    auto&& uuid = UUID::generate();
+    auto&& smtlib2_state = s.to_smt2();
+
+    std::ofstream dump{ dump_dir.getUnsafe() + "/" + uuid.unparsed() + ".smt2" };
+
+    if (dump) {
+        dump << smtlib2_state << std::endl;
+    } else {
+        logging::wtf() << "Could not dump Z3 state to: " << dump_dir.getUnsafe() << endl;
+    }
+}
+
 void Solver::interrupt() {
     z3ef.unwrap().interrupt();
 }
@@ -79,9 +100,7 @@ Solver::check_result Solver::check(
 
     TRACE_FUNC;
 
-    auto&& s = tactics(force_timeout.get(0)).mk_solver();
-
-    auto&& wtf = logging::wtf();
+    auto&& s = tactics(QueryTimeout::apply(force_timeout.get(0))).mk_solver();
 
     auto&& z3state = useProactiveSimplify.get(false) ? z3state_.simplify() : z3state_;
     auto&& z3query = useProactiveSimplify.get(false) ? z3query_.simplify() : z3query_;
@@ -115,18 +134,7 @@ Solver::check_result Solver::check(
     auto&& pred = z3ef.getBoolVar("$CHECK$");
     s.add(pred.implies(z3query).getExpr());
 
-    if (auto&& dump_dir = dump_smt2_state.get()) {
-        auto&& uuid = UUID::generate();
-        auto&& smtlib2_state = s.to_smt2();
-
-        std::ofstream dump{ dump_dir.getUnsafe() + "/" + uuid.unparsed() + ".smt2" };
-
-        if (dump) {
-            dump << smtlib2_state << std::endl;
-        } else {
-            wtf << "Could not dump Z3 state to: " << dump_dir.getUnsafe() << endl;
-        }
-    }
+    dumpSolver(s, dump_smt2_state.get());
 
     {
         TRACE_BLOCK("z3::check");
@@ -168,18 +176,7 @@ Solver::check_result Solver::check(
             return std::make_tuple(r, util::nothing(), util::just(core), util::nothing());
 
         } else { // z3::unknown
-            if(auto&& dump_dir = dump_unknown_smt2_state.get()) {
-                auto&& uuid = UUID::generate();
-                auto&& smtlib2_state = s.to_smt2();
-
-                std::ofstream dump{ dump_dir.getUnsafe() + "/" + uuid.unparsed() + ".smt2" };
-
-                if (dump) {
-                    dump << smtlib2_state << std::endl;
-                } else {
-                    wtf << "Could not dump Z3 state to: " << dump_dir.getUnsafe() << endl;
-                }
-            }
+            dumpSolver(s, dump_unknown_smt2_state.get());
 
             auto&& reason = s.reason_unknown();
             dbg << reason << endl;
@@ -188,27 +185,36 @@ Solver::check_result Solver::check(
     }
 }
 
-template<class TermCollection>
-Model::assignments_t recollectModel(
+static Term::Ptr recollectVariable(
     ExprFactory& z3ef,
     ExecutionContext& ctx,
     z3::model& implModel,
-    const TermCollection& vars) {
-    TRACE_FUNC
+    Term::Ptr var) {
     USING_SMT_LOGIC(Z3)
 
     FactoryNest FN;
 
-    return util::viewContainer(vars)
-        .map([&](auto&& var) {
-            auto&& e = SMT<Z3>::doit(var, z3ef, &ctx);
-            auto&& z3e = e.getExpr();
+    auto&& e = SMT<Z3>::doit(var, z3ef, &ctx);
+    auto&& z3e = e.getExpr();
 
-            dbgs() << "Evaluating " << z3e << endl;
+    dbgs() << "Evaluating " << z3e << endl;
 
-            auto&& retz3e = implModel.eval(z3e, true);
+    auto&& retz3e = implModel.eval(z3e, true);
 
-            return std::make_pair(var, unlogic::undoThat(FN, var, Dynamic(z3ef.unwrap(), retz3e)));
+    return unlogic::undoThat(FN, var, Dynamic(z3ef.unwrap(), retz3e));
+}
+
+template<class TermCollection>
+Model::assignments_t recollectModel(
+    ExprFactory& z3ef,
+    ExecutionContext& ctx,
+    z3::model& implModel,
+    const TermCollection& vars) {
+    TRACE_FUNC
+
+    return util::viewContainer(vars)
+        .map([&](auto&& var) {
+            return std::make_pair(var, recollectVariable(z3ef, ctx, implModel, var));
         })
         .template to<Model::assignments_t>();
 }
@@ -269,6 +275,49 @@ void recollectMemory(
     return;
 }
 
+// Keeps the native model together with everything needed to evaluate terms against it
+class LazyModelEvaluator: public Model::Evaluator {
+    // declared first to be destroyed last: everything below lives in its context
+    std::shared_ptr<ExprFactory> z3ef;
+    ExecutionContext ctx;
+    z3::model implModel;
+
+public:
+    LazyModelEvaluator(std::shared_ptr<ExprFactory> z3ef, const ExecutionContext& ctx, const z3::model& implModel):
+        z3ef(z3ef), ctx(ctx), implModel(implModel) {}
+
+    Term::Ptr evaluate(Term::Ptr var) override {
+        return recollectVariable(*z3ef, ctx, implModel, var);
+    }
+
+    void evaluateMemory(Model& model, Term::Ptr ptr) override {
+        recollectMemory(model, *z3ef, ctx, implModel, std::vector<Term::Ptr>{ ptr });
+    }
+};
+
+std::shared_ptr<Model> Solver::makeModel(
+        PredicateState::Ptr query,
+        PredicateState::Ptr state,
+        ExecutionContext& ctx,
+        z3::model& implModel) {
+    TRACE_FUNC;
+
+    FactoryNest FN;
+    auto&& vars = collectVariables(FN, query, state);
+    auto&& pointers = collectPointers(FN, query, state);
+
+    auto&& model = std::make_shared<Model>(FN);
+
+    if (lazy_models.get(false) and z3efOwner) {
+        model->setEvaluator(std::make_shared<LazyModelEvaluator>(z3efOwner, ctx, implModel), vars, pointers);
+        return model;
+    }
+
+    model->getAssignments() = recollectModel(z3ef, ctx, implModel, vars);
+    recollectMemory(*model, z3ef, ctx, implModel, pointers);
+    return model;
+}
+
 static z3::tactic dd_tactics(ExprFactory& z3ef, unsigned int timeout) {
     auto&& c = z3ef.unwrap();
 
@@ -282,6 +331,49 @@ static z3::tactic dd_tactics(ExprFactory& z3ef, unsigned int timeout) {
     return useful & smt_tactic;
 }
 
+void Solver::sanityCheck(
+        PredicateState::Ptr state,
+        const Bool& z3state,
+        const ExecutionContext& ctx) {
+
+    if (not sanity_check.get(false)) return;
+
+    TRACE_BLOCK("z3::sanity_check");
+    auto&& ss = tactics(sanity_check_timeout.get(5) * 1000).mk_solver();
+    util::viewContainer(uniqueAxioms(ctx)).foreach(APPLY(ss.add));
+    ss.add(z3state.asAxiom());
+
+    auto&& dbg = dbgs();
+
+    dbg << "Checking state for sanity... ";
+    auto&& r = ss.check();
+    if (z3::sat != r) {
+        dbg << (z3::unsat == r ? "FAILED" : "TIMEOUT") << endl;
+
+        logging::wtf() << "Sanity check failed for: " << state << endl;
+
+        static config::ConfigEntry<int> dd_number("analysis", "dd-number");
+        static config::ConfigEntry<int> dd_timeout("analysis", "dd-timeout");
+        auto reduction = [&](auto&& state) {
+            auto&& s = dd_tactics(z3ef, dd_timeout.get(5) * 1000).mk_solver();
+
+            ExecutionContext ctx(z3ef, memoryStart, memoryEnd);
+            auto&& z3state = SMT<Z3>::doit(state, z3ef, &ctx);
+
+            s.add(z3state.asAxiom());
+
+            return (z3::sat == s.check());
+        };
+
+        auto&& dd = makeDeltaDebugger(reduction, dd_number.get(1000)).reduce(state);
+        logging::wtf() << "Delta debugged to: " << dd << endl;
+
+    } else {
+        dbg << "OK" << endl;
+    }
+    dbg << end;
+}
+
 Result Solver::isViolated(
         PredicateState::Ptr query,
         PredicateState::Ptr state) {
@@ -323,42 +415,7 @@ Result Solver::isViolated(
     auto&& z3query = SMT<Z3>::doit(query, z3ef, &ctx);
     dbgs() << "! query conversion finished" << endl;
 
-    if (sanity_check.get(false)) {
-        TRACE_BLOCK("z3::sanity_check");
-        auto&& ss = tactics(sanity_check_timeout.get(5) * 1000).mk_solver();
-        util::viewContainer(uniqueAxioms(ctx)).foreach(APPLY(ss.add));
-        ss.add(z3state.asAxiom());
-
-        auto&& dbg = dbgs();
-
-        dbg << "Checking state for sanity... ";
-        auto&& r = ss.check();
-        if (z3::sat != r) {
-            dbg << (z3::unsat == r ? "FAILED" : "TIMEOUT") << endl;
-
-            logging::wtf() << "Sanity check failed for: " << state << endl;
-
-            static config::ConfigEntry<int> dd_number("analysis", "dd-number");
-            static config::ConfigEntry<int> dd_timeout("analysis", "dd-timeout");
-            auto reduction = [&](auto&& state) {
-                auto&& s = dd_tactics(z3ef, dd_timeout.get(5) * 1000).mk_solver();
-
-                ExecutionContext ctx(z3ef, memoryStart, memoryEnd);
-                auto&& z3state = SMT<Z3>::doit(state, z3ef, &ctx);
-
-                s.add(z3state.asAxiom());
-
-                return (z3::sat == s.check());
-            };
-
-            auto&& dd = makeDeltaDebugger(reduction, dd_number.get(1000)).reduce(state);
-            logging::wtf() << "Delta debugged to: " << dd << endl;
-
-        } else {
-            dbg << "OK" << endl;
-        }
-        dbg << end;
-    }
+    sanityCheck(state, z3state, ctx);
 
     z3::check_result res;
     util::option<z3::model> model;
@@ -369,14 +426,13 @@ Result Solver::isViolated(
     if (z3::sat == res) {
         auto m = model.getUnsafe(); // You shall not fail! (c)
 
-        auto&& cex = state
-            ->filterByTypes({PredicateType::PATH})
-            ->filter([&](auto&& p) {
-                auto&& z3p = SMT<Z3>::doit(p, z3ef, &ctx);
-                auto&& valid = m.eval(z3p.asAxiom());
-                auto&& bValid = util::stringCast<bool>(valid);
-                return bValid.getOrElse(false);
-            });
+        FactoryNest FN;
+        auto&& cex = BatchEvaluator<Z3>(FN, z3ef, ctx).filterPath(state, [&](auto&& packed, auto&& witness) {
+            // no model completion, predicates over unassigned variables are left out of the CEX
+            auto&& value = m.eval(packed.getExpr());
+            if (not value.is_numeral()) return Term::Ptr{};
+            return unlogic::undoThat(FN, witness, Dynamic(z3ef.unwrap(), value));
+        });
 
         using namespace logging;
         dbgs() << "CEX: "
@@ -386,15 +442,7 @@ Result Solver::isViolated(
                << endl;
 
         if (gather_z3_models.get(false) or gather_smt_models.get(false)) {
-            FactoryNest FN;
-            auto&& vars = collectVariables(FN, query, state);
-            auto&& pointers = collectPointers(FN, query, state);
-
-            auto&& model = std::make_shared<Model>(FN);
-
-            model->getAssignments() = recollectModel(z3ef, ctx, m, vars);
-            recollectMemory(*model, z3ef, ctx, m, pointers);
-            return SatResult(model);
+            return SatResult(makeModel(query, state, ctx, m));
         }
 
         return SatResult{};
@@ -407,6 +455,74 @@ Result Solver::isViolated(
     return UnsatResult{};
 }
 
+std::vector<Result> Solver::isViolated(
+        const std::vector<PredicateState::Ptr>& queries,
+        PredicateState::Ptr state) {
+
+    using namespace logic;
+
+    TRACE_FUNC;
+
+    dbgs() << "Checking " << queries.size() << " queries in a batch" << endl;
+
+    ExecutionContext ctx{ z3ef, memoryStart, memoryEnd };
+    dbgs() << "! state conversion started" << endl;
+    auto&& z3state_ = SMT<Z3>::doit(state, z3ef, &ctx);
+    dbgs() << "! state conversion finished" << endl;
+
+    sanityCheck(state, z3state_, ctx);
+
+    // the same solver as for a single query, only every query is guarded by its own literal
+    auto&& s = tactics(QueryTimeout::apply(force_timeout.get(0))).mk_solver();
+
+    auto&& z3state = useProactiveSimplify.get(false) ? z3state_.simplify() : z3state_;
+
+    std::vector<z3::expr> literals;
+    literals.reserve(queries.size());
+    for (auto i = 0U; i < queries.size(); ++i) {
+        auto&& z3query_ = not SMT<Z3>::doit(queries[i], z3ef, &ctx);
+        auto&& z3query = useProactiveSimplify.get(false) ? z3query_.simplify() : z3query_;
+        auto&& literal = z3ef.getBoolVar(tfm::format("$CHECK$%d", i));
+        s.add(z3query.getAxiom());
+        s.add(literal.implies(z3query).getExpr());
+        literals.push_back(literal.getExpr());
+    }
+
+    s.add(z3state.asAxiom());
+    util::viewContainer(uniqueAxioms(ctx)).foreach(APPLY(s.add));
+
+    dumpSolver(s, dump_smt2_state.get());
+
+    std::vector<Result> results;
+    results.reserve(queries.size());
+    for (auto i = 0U; i < queries.size(); ++i) {
+        z3::check_result res;
+        {
+            TRACE_BLOCK("z3::check");
+            res = s.check(1, &literals[i]);
+        }
+        dbgs() << "Acquired result for query " << i << ": "
+               << ((res == z3::sat) ? "sat" : (res == z3::unsat) ? "unsat" : "unknown")
+               << endl;
+
+        if (z3::sat == res) {
+            if (gather_z3_models.get(false) or gather_smt_models.get(false)) {
+                auto&& m = s.get_model();
+                results.push_back(SatResult(makeModel(queries[i], state, ctx, m)));
+            } else {
+                results.push_back(SatResult{});
+            }
+        } else if (z3::unknown == res) {
+            dumpSolver(s, dump_unknown_smt2_state.get());
+            results.push_back(UnknownResult{});
+        } else {
+            results.push_back(UnsatResult{});
+        }
+    }
+
+    return results;
+}
+
 Result Solver::isPathImpossible(
         PredicateState::Ptr path,
         PredicateState::Ptr state) {
@@ -430,15 +546,7 @@ Result Solver::isPathImpossible(
 
         // XXX: Do we need model collection for path possibility queries???
         if (gather_z3_models.get(false) or gather_smt_models.get(false)) {
-            FactoryNest FN;
-            auto&& vars = collectVariables(FN, path, state);
-            auto&& pointers = collectPointers(FN, path, state);
-
-            auto&& model = std::make_shared<Model>(FN);
-
-            model->getAssignments() = recollectModel(z3ef, ctx, m, vars);
-            recollectMemory(*model, z3ef, ctx, m, pointers);
-            return SatResult(model);
+            return SatResult(makeModel(path, state, ctx, m));
         }
 
         return SatResult{};
@@ -515,11 +623,17 @@ PredicateState::Ptr Solver::probeModels(
     auto&& z3divers = t2e(diversifiers);
     auto&& z3collects = t2e(collectibles);
 
-    auto&& solver = tactics(force_timeout.get(0)).mk_solver();
+    auto&& solver = tactics(QueryTimeout::apply(force_timeout.get(0))).mk_solver();
     solver.add(z3body.asAxiom());
     solver.add(z3query.asAxiom());
     util::viewContainer(uniqueAxioms(ctx)).foreach(APPLY(solver.add));
 
+    // checks that the query holds for every completion of a candidate model,
+    // the body and the negated query are asserted once, candidates are tried in their own scopes
+    auto&& usolver = tactics(QueryTimeout::apply(force_timeout.get(0))).mk_solver();
+    usolver.add(z3body.asAxiom());
+    usolver.add((not z3query).asAxiom());
+
     FactoryNest FN;
     std::vector<PredicateState::Ptr> states;
     states.reserve(countLimit);
@@ -528,23 +642,22 @@ PredicateState::Ptr Solver::probeModels(
     auto&& attempt = 0U;
     auto&& fullCount = 0U; // for logging
 
+    // blocking clauses added by diversification are dropped afterwards
+    solver.push();
     while (count < countLimit && attempt < attemptLimit) {
         auto&& models = z3::diversify_unsafe(solver, z3divers, countLimit * 2);
 
         for (auto&& model : models) {
             ++fullCount; // for logging
 
-            auto&& z3model = model2expr(model, z3collects);
-            auto&& stateModel = model2state(model, collectibles, z3collects);
-
-            auto&& usolver = tactics(force_timeout.get(0)).mk_solver();
-            usolver.add(z3body.asAxiom());
-            usolver.add((not z3query).asAxiom());
-            usolver.add( z3model );
+            usolver.push();
+            usolver.add(model2expr(model, z3collects));
+            auto&& res = usolver.check();
+            usolver.pop();
 
-            if (z3::sat == usolver.check()) continue;
+            if (z3::sat == res) continue;
 
-            states.push_back(stateModel);
+            states.push_back(model2state(model, collectibles, z3collects));
             ++count;
 
             if (count >= countLimit) break;
@@ -552,6 +665,7 @@ PredicateState::Ptr Solver::probeModels(
 
         ++attempt;
     }
+    solver.pop();
 
     dbgs() << "Attempts: " << attempt << endl
            << "Count: " << fullCount << endl;
@@ -31,11 +31,19 @@ public:
 #include "Util/unmacros.h"
 
     Solver(ExprFactory& z3ef, unsigned long long memoryStart, unsigned long long memoryEnd);
+    // models returned by a solver owning its factory may stay lazy, as they can keep the context alive
+    Solver(std::shared_ptr<ExprFactory> z3ef, unsigned long long memoryStart, unsigned long long memoryEnd);
 
     smt::Result isViolated(
             PredicateState::Ptr query,
             PredicateState::Ptr state);
 
+    // checks every query against the same state: the state is asserted once,
+    // and each query is enabled by its own assumption literal
+    std::vector<smt::Result> isViolated(
+            const std::vector<PredicateState::Ptr>& queries,
+            PredicateState::Ptr state);
+
     smt::Result isPathImpossible(
             PredicateState::Ptr path,
             PredicateState::Ptr state);
@@ -51,6 +59,7 @@ public:
 private:
 
     ExprFactory& z3ef;
+    std::shared_ptr<ExprFactory> z3efOwner;
     unsigned long long memoryStart;
     unsigned long long memoryEnd;
 
@@ -66,8 +75,20 @@ private:
             const Bool& z3state,
             const ExecutionContext& ctx);
 
+    // checks that @state is satisfiable on its own, if analysis.sanity-check is on
+    void sanityCheck(
+            PredicateState::Ptr state,
+            const Bool& z3state,
+            const ExecutionContext& ctx);
+
     z3::tactic tactics(unsigned int timeout = 0);
 
+    std::shared_ptr<smt::Model> makeModel(
+            PredicateState::Ptr query,
+            PredicateState::Ptr state,
+            ExecutionContext& ctx,
+            z3::model& implModel);
+
 };
 
 } // namespace z3_
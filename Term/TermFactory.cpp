@@ -27,7 +27,8 @@ static Term::Ptr poolAlloc(Pool& pool, Args&&... args) {
 template<class T, class ...Args>
 static Term::Ptr make_pooled(Args &&... args) {
     using pool_t = MemoryPool<T, 128 * sizeof(T)>;
-    static pool_t valuePool;
+    // never destroyed, as pooled terms may be kept by other statics
+    static pool_t& valuePool = *new pool_t;
 
     return poolAlloc<T>(valuePool, std::forward<Args>(args)...);
 };
@@ -53,6 +53,21 @@ public:
     typedef std::shared_ptr<const Type> Ptr;
     typedef std::unique_ptr<proto::Type> ProtoPtr;
 
+private:
+    friend class TypeFactory;
+
+    // assigned once by the factory, when the type is interned
+    mutable size_t structuralHash = 0U;
+    mutable unsigned typeId = 0U;
+    mutable unsigned shapeId = 0U;
+
+public:
+    size_t getStructuralHash() const { return structuralHash; }
+    // interned types are unique, so equal ids mean equal types
+    unsigned getTypeId() const { return typeId; }
+    // same for the types that differ only in integer signedness
+    unsigned getShapeId() const { return shapeId; }
+
 };
 
 } // namespace borealis
@@ -12,6 +12,7 @@
 #include "Type/TypeFactory.h"
 #include "Type/TypeVisitor.hpp"
 #include "Util/cast.hpp"
+#include "Util/hash.hpp"
 #include "Util/util.h"
 
 #include "Util/macros.h"
@@ -25,70 +26,78 @@ TypeFactory::Ptr TypeFactory::get() {
     return instance;
 }
 
+Type::Ptr TypeFactory::enroll(Type::Ptr type, size_t hash) const {
+    type->structuralHash = hash;
+    type->typeId = type->shapeId = ++lastTypeId;
+    return type;
+}
+
 Type::Ptr TypeFactory::getBool() const {
-    if (!theBool) return theBool = Type::Ptr(new type::Bool());
+    if (!theBool) return theBool = enroll(Type::Ptr(new type::Bool()), util::hash::defaultHasher()(class_tag<type::Bool>()));
     else return theBool;
 }
 
 Type::Ptr TypeFactory::getInteger(size_t bitsize, llvm::Signedness sign) const {
-    auto&& pair = std::make_pair(bitsize, sign);
-    if (auto existing = util::at(integers, pair)) return existing.getUnsafe();
-    else return integers[pair] = Type::Ptr(new type::Integer(bitsize, sign));
+    auto&& hash = util::hash::defaultHasher()(class_tag<type::Integer>(), bitsize, static_cast<int>(sign));
+    auto&& res = intern<type::Integer>(
+        hash,
+        [&](const type::Integer* t) { return t->getBitsize() == bitsize && t->getSignedness() == sign; },
+        [&]() { return Type::Ptr(new type::Integer(bitsize, sign)); }
+    );
+    // a fresh signed or unsigned integer takes the shape of the one with unknown signedness
+    if (sign != llvm::Signedness::Unknown && res->shapeId == res->typeId) {
+        res->shapeId = getInteger(bitsize, llvm::Signedness::Unknown)->typeId;
+    }
+    return res;
 }
 
 Type::Ptr TypeFactory::getFloat() const {
-    if (!theFloat) return theFloat = Type::Ptr(new type::Float());
+    if (!theFloat) return theFloat = enroll(Type::Ptr(new type::Float()), util::hash::defaultHasher()(class_tag<type::Float>()));
     else return theFloat;
 }
 
 Type::Ptr TypeFactory::getUnknownType() const {
-    if (!theUnknown) return theUnknown = Type::Ptr(new type::UnknownType());
+    if (!theUnknown) return theUnknown = enroll(Type::Ptr(new type::UnknownType()), util::hash::defaultHasher()(class_tag<type::UnknownType>()));
     else return theUnknown;
 }
 
 Type::Ptr TypeFactory::getPointer(Type::Ptr to, size_t memspace) const {
     if (TypeUtils::isInvalid(to)) return to;
-    auto key = std::make_pair(to, memspace);
-
-    if (auto existing = util::at(pointers, key)) return existing.getUnsafe();
-    else return pointers[key] = Type::Ptr(new type::Pointer(to, memspace));
+    return intern<type::Pointer>(
+        util::hash::defaultHasher()(class_tag<type::Pointer>(), to->getStructuralHash(), memspace),
+        [&](const type::Pointer* t) { return t->getPointed() == to && t->getMemspace() == memspace; },
+        [&]() { return Type::Ptr(new type::Pointer(to, memspace)); }
+    );
 }
 
 Type::Ptr TypeFactory::getArray(Type::Ptr elem, size_t size) const {
     if (TypeUtils::isInvalid(elem)) return elem;
-    auto&& pair = std::make_pair(elem, size);
-    if (auto existing = util::at(arrays, pair)) return existing.getUnsafe();
-    else return arrays[pair] = Type::Ptr(
-            new type::Array(
-                elem,
-                size != 0U ? util::just(size) : util::nothing()
-            )
-        );
+    return intern<type::Array>(
+        util::hash::defaultHasher()(class_tag<type::Array>(), elem->getStructuralHash(), size),
+        [&](const type::Array* t) { return t->getElement() == elem && t->getSize().getOrElse(0U) == size; },
+        [&]() {
+            return Type::Ptr(
+                new type::Array(
+                    elem,
+                    size != 0U ? util::just(size) : util::nothing()
+                )
+            );
+        }
+    );
 }
 
 Type::Ptr TypeFactory::getRecord(const std::string& name, const llvm::StructType* st, const llvm::DataLayout* dl) const {
-    static std::unordered_set<const llvm::StructType*> visitedRecordTypes;
-
     if (auto existing = util::at(records, name)) return existing.getUnsafe();
-    else {
-        if (not recordBodies->count(name) && st && not visitedRecordTypes.count(st)) {
-            visitedRecordTypes.insert(st);
 
-            if(st->isOpaque()) {
-                return records[name] = getUnknownType();
-            }
-
-            auto sl = dl->getStructLayout(const_cast<llvm::StructType*>(st)); // why, llvm, why???
-
-            type::RecordBody rb{
-                util::range(0U, st->getNumElements())
-                .map(LAM(ix, type::RecordField{this->cast(st->getElementType(ix), dl), sl->getElementOffsetInBits(ix)} ))
-                .toVector()
-            };
+    auto&& needsBody = st && not recordBodies->count(name);
+    if (needsBody && st->isOpaque()) {
+        return records[name] = getUnknownType();
+    }
 
-            embedRecordBodyNoRecursion(name, rb);
-        }
-        return records[name] = Type::Ptr(
+    // the record is interned before its body is built,
+    // so that recursive references resolve to the same type
+    Type::Ptr res = records[name] = enroll(
+        Type::Ptr(
             new type::Record(
                 name,
                 type::RecordBodyRef::Ptr(
@@ -98,23 +107,41 @@ Type::Ptr TypeFactory::getRecord(const std::string& name, const llvm::StructType
                     )
                 )
             )
-        );
+        ),
+        util::hash::defaultHasher()(class_tag<type::Record>(), name)
+    );
+
+    if (needsBody) {
+        auto sl = dl->getStructLayout(const_cast<llvm::StructType*>(st)); // why, llvm, why???
+
+        type::RecordBody rb{
+            util::range(0U, st->getNumElements())
+            .map(LAM(ix, type::RecordField{this->cast(st->getElementType(ix), dl), sl->getElementOffsetInBits(ix)} ))
+            .toVector()
+        };
+
+        embedRecordBodyNoRecursion(name, rb);
     }
+    return res;
 }
 
 Type::Ptr TypeFactory::getTypeError(const std::string& message) const {
-    if (auto existing = util::at(errors, message)) return existing.getUnsafe();
-    else return errors[message] = Type::Ptr(new type::TypeError(message));
+    return intern<type::TypeError>(
+        util::hash::defaultHasher()(class_tag<type::TypeError>(), message),
+        [&](const type::TypeError* t) { return t->getMessage() == message; },
+        [&]() { return Type::Ptr(new type::TypeError(message)); }
+    );
 }
 
 Type::Ptr TypeFactory::getFunction(Type::Ptr retty, const std::vector<Type::Ptr>& args) const {
-    std::vector<Type::Ptr> key;
-    key.reserve(1 + args.size());
-    key.push_back(retty);
-    key.insert(key.end(), args.begin(), args.end());
+    auto hash = util::hash::defaultHasher()(class_tag<type::Function>(), retty->getStructuralHash());
+    for (auto&& arg : args) hash = util::hash::defaultHasher()(hash, arg->getStructuralHash());
 
-    if (auto existing = util::at(functions, key)) return existing.getUnsafe();
-    else return functions[std::move(key)] = Type::Ptr(new type::Function(retty, args));
+    return intern<type::Function>(
+        hash,
+        [&](const type::Function* t) { return t->getRetty() == retty && t->getArgs() == args; },
+        [&]() { return Type::Ptr(new type::Function(retty, args)); }
+    );
 }
 
 void TypeFactory::initialize(const VariableInfoTracker& mit) {
@@ -122,6 +149,8 @@ void TypeFactory::initialize(const VariableInfoTracker& mit) {
     static const VariableInfoTracker* lastMIT;
     if(&mit == lastMIT) return;
     lastMIT = &mit;
+    // struct types of other modules may be gone by now, records are still known by name
+    structs.clear();
 
     DebugInfoFinder dfi;
     dfi.processModule(mit.getModule());
@@ -151,8 +180,9 @@ Type::Ptr TypeFactory::cast(const llvm::Type* type, const llvm::DataLayout* dl,
     else if (type->isVectorTy())
         return getArray(cast(type->getVectorElementType(), dl), type->getVectorNumElements());
     else if (auto* str = llvm::dyn_cast<llvm::StructType>(type)) {
+        if (auto existing = util::at(structs, str)) return existing.getUnsafe();
         auto&& name = str->hasName() ? str->getStructName().str() : util::toString(*str); // FIXME: use TypePrinting or SlotTrackerPass
-        return getRecord(name, str, dl);
+        return structs[str] = getRecord(name, str, dl);
     } else if (type->isMetadataTy()) // we use metadata for unknown stuff
         return getUnknownType();
     else if (auto* func = llvm::dyn_cast<llvm::FunctionType>(type)) {
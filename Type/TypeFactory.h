@@ -22,15 +22,31 @@ class TypeFactory {
     mutable Type::Ptr theFloat;
     mutable Type::Ptr theUnknown;
 
-    mutable std::unordered_map<std::pair<size_t, llvm::Signedness>, Type::Ptr> integers;
-    mutable std::unordered_map<std::pair<Type::Ptr, size_t>,        Type::Ptr> pointers;
-    mutable std::unordered_map<std::pair<Type::Ptr, size_t>,        Type::Ptr> arrays;
-    mutable std::unordered_map<std::string,                         Type::Ptr> errors;
+    // hash-consing table of all the structural types, keyed by their structural hashes;
+    // every type made here gets a dense id when it is enrolled
+    mutable std::unordered_multimap<size_t, Type::Ptr> table;
+    mutable unsigned lastTypeId = 0U;
 
+    // records are nominal, so they are interned by name
     mutable std::unordered_map<std::string, Type::Ptr> records;
     mutable type::RecordRegistry::StrongPtr  recordBodies;
 
-    mutable std::unordered_map<std::vector<Type::Ptr>, Type::Ptr> functions;
+    // llvm struct types of the current module, so that their records are looked up once
+    mutable std::unordered_map<const llvm::StructType*, Type::Ptr> structs;
+
+    Type::Ptr enroll(Type::Ptr type, size_t hash) const;
+
+    template<class T, class Same, class Make>
+    Type::Ptr intern(size_t hash, Same&& same, Make&& make) const {
+        auto&& range = table.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            auto&& existing = llvm::dyn_cast<T>(it->second.get());
+            if (existing && same(existing)) return it->second;
+        }
+        auto&& res = enroll(make(), hash);
+        table.emplace(hash, res);
+        return res;
+    }
 
 public:
 
@@ -5,6 +5,7 @@
 #ifndef INDEXED_STRING_HPP
 #define INDEXED_STRING_HPP
 
+#include <deque>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -20,22 +21,72 @@ namespace util {
 
 namespace impl_ {
 
+// Interned strings with reference counts.
+// Strings nobody refers to are not dropped right away, but in bulk when a generation ends,
+// so that a string dropped and interned again within one generation keeps its id.
+// Ids of reclaimed strings are reused
 struct string_cache {
-    std::vector<std::string> fwd;
-    std::unordered_map<std::string, size_t> bwd;
+    struct entry {
+        std::string str;
+        size_t refs = 0;
+        bool live = false;
+    };
+
+    // entries never move, so the index can refer to their strings
+    std::deque<entry> fwd;
+    std::unordered_map<string_ref, size_t> bwd;
+    std::vector<size_t> reclaimed;
+    size_t unreferenced = 0;
 
     size_t operator[](string_ref key) {
         auto it = bwd.find(key);
         if(it != std::end(bwd)) {
             return it->second;
+        }
+
+        size_t id;
+        if(reclaimed.empty()) {
+            id = fwd.size();
+            fwd.emplace_back();
         } else {
-            fwd.push_back(key.str());
-            return bwd[fwd.back()] = fwd.size() - 1;
+            id = reclaimed.back();
+            reclaimed.pop_back();
         }
+        auto& e = fwd[id];
+        e.str = key.str();
+        e.live = true;
+        ++unreferenced;
+        return bwd[e.str] = id;
     }
 
     const std::string& operator[](size_t key) {
-        return fwd[key];
+        return fwd[key].str;
+    }
+
+    void acquire(size_t key) {
+        if(fwd[key].refs++ == 0) --unreferenced;
+    }
+
+    void release(size_t key) {
+        if(--fwd[key].refs == 0) ++unreferenced;
+    }
+
+    // drops unreferenced strings if there are enough of them, returns their number
+    size_t nextGeneration() {
+        if(unreferenced * 2 < bwd.size()) return 0;
+
+        size_t dropped = 0;
+        for(size_t id = 0; id < fwd.size(); ++id) {
+            auto& e = fwd[id];
+            if(!e.live || e.refs > 0) continue;
+            bwd.erase(e.str);
+            std::string{}.swap(e.str);
+            e.live = false;
+            reclaimed.push_back(id);
+            ++dropped;
+        }
+        unreferenced = 0;
+        return dropped;
     }
 
 };
@@ -46,16 +97,40 @@ class indexed_string {
     size_t id;
 
     static impl_::string_cache& cache_instance() {
-        static impl_::string_cache cache;
-        return cache;
+        // never destroyed: static indexed_strings may outlive any static cache
+        static auto* cache = new impl_::string_cache;
+        return *cache;
+    }
+
+    indexed_string(size_t id): id(id) {
+        cache_instance().acquire(id);
     }
 
 public:
-    indexed_string(string_ref str): id(cache_instance()[str]) {}
-    indexed_string(const std::string& str): id(cache_instance()[str]) {}
-    indexed_string(const char* str): id(cache_instance()[str]) {}
+    indexed_string(string_ref str): indexed_string(cache_instance()[str]) {}
+    indexed_string(const std::string& str): indexed_string(cache_instance()[str]) {}
+    indexed_string(const char* str): indexed_string(cache_instance()[str]) {}
     indexed_string(): indexed_string("") {}
 
+    indexed_string(const indexed_string& that): indexed_string(that.id) {}
+    indexed_string& operator=(const indexed_string& that) {
+        cache_instance().acquire(that.id);
+        cache_instance().release(id);
+        id = that.id;
+        return *this;
+    }
+
+    ~indexed_string() {
+        cache_instance().release(id);
+    }
+
+    // marks a point between independent pieces of work (e.g., functions),
+    // where the strings nobody refers to anymore may be reclaimed;
+    // returns the number of reclaimed strings
+    static size_t nextGeneration() {
+        return cache_instance().nextGeneration();
+    }
+
     size_t hash() const {
         return hash::simple_hash_value(id);
     }
@@ -100,8 +175,8 @@ struct json_traits<indexed_string> {
     using optional_ptr_t = std::unique_ptr<indexed_string>;
 
     static json::Value toJson(const indexed_string& val) {
-        json::Value ret{ json::Value::StaticString, val.c_str(), val.size() };
-        return ret;
+        // the string may be reclaimed before the value is written, so it is copied
+        return json::Value(val.str());
     }
 
     static optional_ptr_t fromJson(const json::Value& val) {
@@ -21,8 +21,12 @@ class irf_base_base {
     mutable size_t counter = 0;
 
 public:
+    irf_base_base() = default;
+    // copies are not referenced by anyone yet
+    irf_base_base(const irf_base_base&) {}
+
     void inc() const { ++counter; }
-    void dec() const { ++counter; }
+    void dec() const { --counter; }
     bool empty() const { return counter == 0; }
 
     ~irf_base_base() {}
@@ -36,9 +40,11 @@ class irfd_base_base {
 public:
     irfd_base_base(Deleter d): deleter_(d) {}
     irfd_base_base() = default;
+    // copies are not referenced by anyone yet
+    irfd_base_base(const irfd_base_base& that): deleter_(that.deleter_) {}
 
     void inc() const { ++counter; }
-    void dec() const { ++counter; }
+    void dec() const { --counter; }
     bool empty() const { return counter == 0; }
 
     Deleter& deleter() const { return deleter_; }
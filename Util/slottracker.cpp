@@ -91,6 +91,11 @@ inline void SlotTracker::initializeFunction() {
         processFunction();
 }
 
+void SlotTracker::initialize() {
+    initializeModule();
+    initializeFunction();
+}
+
 // Iterate through all the global variables, functions, and global
 // variable initializers and create slots for them.
 void SlotTracker::processModule() {
@@ -118,6 +118,8 @@ public:
   /// This function does the actual initialization.
   inline void initializeModule();
   inline void initializeFunction();
+  /// Numbers everything at once, so that the tracker is only read afterwards
+  void initialize();
 
   // Implementation Details
 private:
@@ -8,8 +8,14 @@
 #include <gtest/gtest.h>
 
 #include <math.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 
 #include "Factory/Nest.h"
+#include "Passes/Misc/ContractDatabase.h"
 #include "Protobuf/Converter.hpp"
 
 namespace {
@@ -63,4 +69,72 @@ TEST(Protobuf, protobuffy) {
 
 }
 
+TEST(Protobuf, contractDatabase) {
+
+    using namespace borealis;
+
+    auto&& prefix = "/tmp/borealis-contracts-" + std::to_string(::getpid());
+    auto&& source = prefix + ".json";
+    auto&& cache = prefix + ".db";
+    {
+        std::ofstream json(source);
+        json << R"([
+            { "name": "first", "signature": "void first(int* p)" },
+            { "name": "second", "signature": "int second(int* p)",
+              "contracts": [ "@requires \\is_valid_ptr(\\arg0)" ] }
+        ])";
+    }
+
+    auto FN = FactoryNest();
+    {
+        ContractDatabase db({ source }, cache);
+        EXPECT_FALSE(db.load());
+        db.build(FN);
+    }
+
+    {
+        ContractDatabase db({ source }, cache);
+        ASSERT_TRUE(db.load());
+        ASSERT_EQ(db.ids(), (std::vector<std::string>{ "first", "second" }));
+
+        auto&& entry = db.materialize(1, FN);
+        ASSERT_TRUE(!!entry);
+        EXPECT_EQ(entry.getUnsafe().info.id, "second");
+        EXPECT_EQ(entry.getUnsafe().info.signature, "int second(int* p)");
+        EXPECT_EQ(entry.getUnsafe().contracts.size(), 1U);
+    }
+
+    {
+        // the info of the first entry is broken, but its framing is not
+        std::string contents;
+        {
+            std::ifstream input(cache, std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        }
+        auto&& info = contents.find("void first(int* p)");
+        ASSERT_NE(info, std::string::npos);
+        contents[info] = '"';
+        {
+            std::ofstream output(cache, std::ios::binary);
+            output << contents;
+        }
+
+        ContractDatabase db({ source }, cache);
+        ASSERT_TRUE(db.load());
+        auto&& entry = db.materialize(0, FN);
+        ASSERT_TRUE(!!entry);
+        EXPECT_EQ(entry.getUnsafe().info.id, "first");
+    }
+
+    {
+        // the database has been rebuilt
+        ContractDatabase db({ source }, cache);
+        ASSERT_TRUE(db.load());
+        EXPECT_TRUE(!!db.materialize(0, FN));
+    }
+
+    std::remove(source.c_str());
+    std::remove(cache.c_str());
+}
+
 } // namespace
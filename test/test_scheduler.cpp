@@ -0,0 +1,193 @@
+/*
+ * test_scheduler.cpp
+ */
+
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "Passes/Checker/PendingVerdicts.h"
+#include "Passes/Checker/SolverScheduler.h"
+#include "SMT/Result.h"
+
+namespace {
+
+using namespace borealis;
+
+class SchedulerTest : public ::testing::Test {
+protected:
+
+    typedef std::unique_ptr<llvm::Module> ModulePtr;
+
+    virtual void SetUp() {
+        ctx = &llvm::getGlobalContext();
+        M = ModulePtr(new llvm::Module("mock-module", *ctx));
+        // the budget is shared between two functions with bodies
+        f = define("f");
+        g = define("g");
+    }
+
+    llvm::Function* define(const std::string& name) {
+        using namespace llvm;
+
+        auto* F = Function::Create(
+            FunctionType::get(Type::getVoidTy(*ctx), false),
+            GlobalValue::LinkageTypes::ExternalLinkage,
+            name,
+            M.get()
+        );
+        IRBuilder<> builder(BasicBlock::Create(*ctx, "entry", F));
+        builder.CreateRetVoid();
+        return F;
+    }
+
+    static SolverScheduler::Solve answer(smt::Result result, unsigned millis = 0U) {
+        return [result, millis]() {
+            if (millis) std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+            return result;
+        };
+    }
+
+    llvm::LLVMContext* ctx;
+    ModulePtr M;
+    llvm::Function* f;
+    llvm::Function* g;
+
+};
+
+TEST_F(SchedulerTest, Deferral) {
+    SolverScheduler scheduler(1000, 0);
+    std::vector<std::string> reported;
+    auto&& record = [&](const std::string& name) {
+        return [&reported, name](const smt::Result&) { reported.push_back(name); };
+    };
+
+    // nothing to go by yet, so the first query runs right away
+    scheduler.submit(f, 10, answer(smt::UnsatResult{}, 20), record("small"));
+    EXPECT_EQ(std::vector<std::string>{ "small" }, reported);
+
+    // at the observed rate this one needs way more than the share of f
+    scheduler.submit(f, 1000, answer(smt::UnsatResult{}), record("big"));
+    EXPECT_EQ(std::vector<std::string>{ "small" }, reported);
+
+    // the same size fits the share of g
+    scheduler.submit(g, 10, answer(smt::UnsatResult{}), record("other"));
+    EXPECT_EQ((std::vector<std::string>{ "small", "other" }), reported);
+
+    scheduler.finish();
+    EXPECT_EQ((std::vector<std::string>{ "small", "other", "big" }), reported);
+
+    // nothing is reported twice
+    scheduler.finish();
+    EXPECT_EQ(3U, reported.size());
+}
+
+TEST_F(SchedulerTest, NoBudgetLeft) {
+    SolverScheduler scheduler(100, 0);
+    std::vector<bool> unknown;
+    auto&& record = [&](const smt::Result& result) { unknown.push_back(result.isUnknown()); };
+
+    auto solved = 0U;
+    auto&& counted = [&]() { ++solved; return smt::Result{ smt::UnsatResult{} }; };
+
+    // uses up the share of f and then some
+    scheduler.submit(f, 10, answer(smt::UnsatResult{}, 120), record);
+    scheduler.submit(f, 10, counted, record);
+    EXPECT_EQ(1U, unknown.size());
+
+    // deferred, but the budget is gone by the end of the module
+    scheduler.finish();
+    EXPECT_EQ(0U, solved);
+    EXPECT_EQ((std::vector<bool>{ false, true }), unknown);
+}
+
+TEST_F(SchedulerTest, RetryUnknown) {
+    SolverScheduler scheduler(1000, 50);
+    std::vector<smt::Result> reported;
+
+    auto calls = 0U;
+    auto&& unknownFirst = [&]() {
+        return ++calls == 1 ? smt::Result{ smt::UnknownResult{} } : smt::Result{ smt::UnsatResult{} };
+    };
+
+    scheduler.submit(f, 10, unknownFirst, [&](const smt::Result& result) { reported.push_back(result); });
+    // unknown results are reported only after the retry
+    EXPECT_EQ(1U, calls);
+    EXPECT_TRUE(reported.empty());
+
+    // the reserve gives the retry a longer timeout than the share of f did
+    scheduler.finish();
+    EXPECT_EQ(2U, calls);
+    ASSERT_EQ(1U, reported.size());
+    EXPECT_TRUE(reported.front().isUnsat());
+}
+
+TEST_F(SchedulerTest, AliasOfPendingVerdict) {
+    SolverScheduler scheduler(1000, 0);
+    PendingVerdicts<std::string> pending;
+    std::vector<std::string> settled;
+
+    auto&& submit = [&](const std::string& defect, size_t size, unsigned millis) {
+        pending.await(defect);
+        scheduler.submit(f, size, answer(smt::UnsatResult{}, millis), [&, defect](const smt::Result&) {
+            settled.push_back(defect);
+            pending.settle(defect);
+        });
+    };
+    auto&& alias = [&](const std::string& defect, const std::string& other) {
+        ASSERT_TRUE(pending.isPending(other));
+        pending.await(defect);
+        pending.wait(other, [&, defect]() {
+            settled.push_back(defect);
+            pending.settle(defect);
+        });
+    };
+
+    submit("solved", 10, 20);
+    EXPECT_FALSE(pending.isPending("solved"));
+
+    // deferred, so its aliases (and their aliases) wait until the end of the module
+    submit("deferred", 1000, 0);
+    EXPECT_TRUE(pending.isPending("deferred"));
+    alias("alias", "deferred");
+    alias("alias of alias", "alias");
+    EXPECT_EQ(3U, pending.size());
+    EXPECT_EQ(std::vector<std::string>{ "solved" }, settled);
+
+    scheduler.finish();
+    EXPECT_EQ((std::vector<std::string>{ "solved", "deferred", "alias", "alias of alias" }), settled);
+    EXPECT_EQ(0U, pending.size());
+}
+
+TEST(PendingVerdicts, SettledByLastVerdict) {
+    PendingVerdicts<int> pending;
+    auto runs = 0U;
+
+    // two queries decide the same defect
+    pending.await(1);
+    pending.await(1);
+    pending.wait(1, [&]() { ++runs; });
+
+    pending.settle(1);
+    EXPECT_TRUE(pending.isPending(1));
+    EXPECT_EQ(0U, runs);
+
+    pending.settle(1);
+    EXPECT_FALSE(pending.isPending(1));
+    EXPECT_EQ(1U, runs);
+
+    // settling what is not pending does nothing
+    pending.settle(1);
+    pending.settle(2);
+    EXPECT_EQ(1U, runs);
+    EXPECT_EQ(0U, pending.size());
+}
+
+} // namespace
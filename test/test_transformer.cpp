@@ -10,6 +10,7 @@
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Instruction.h>
 #include <llvm/IR/Instructions.h>
+#include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
@@ -19,6 +20,7 @@
 #include <gtest/gtest.h>
 
 #include "Factory/Nest.h"
+#include "Passes/Checker/ValueNumbering.h"
 #include "State/Transformer/CallSiteInitializer.h"
 #include "State/Transformer/ConstantPropagator.h"
 #include "Term/Term.def"
@@ -210,4 +212,74 @@ TEST_F(TransformerTest, ConstantPropagator) {
     }
 }
 
+TEST_F(TransformerTest, ValueNumbering) {
+    {
+        using namespace llvm;
+        using llvm::Type;
+
+        Type* intType = Type::getInt32Ty(*ctx);
+        Type* ptrType = PointerType::getUnqual(intType);
+        Type* bytePtrType = Type::getInt8PtrTy(*ctx);
+        Function* F = Function::Create(
+            FunctionType::get(
+                Type::getVoidTy(*ctx),
+                std::vector<Type*>{ PointerType::getUnqual(ptrType), intType },
+                false
+            ),
+            GlobalValue::LinkageTypes::ExternalLinkage,
+            "vn",
+            M.get()
+        );
+        Argument* pp = &head(F->getArgumentList());
+        Argument* idx = &F->getArgumentList().back();
+
+        BasicBlock* entry = BasicBlock::Create(*ctx, "entry", F);
+        BasicBlock* then = BasicBlock::Create(*ctx, "then", F);
+        BasicBlock* exit = BasicBlock::Create(*ctx, "exit", F);
+
+        IRBuilder<> builder(entry);
+        auto* p1 = builder.CreateLoad(pp);
+        auto* p2 = builder.CreateLoad(pp);
+        auto* cast = builder.CreateBitCast(p1, bytePtrType);
+        auto* gep1 = builder.CreateGEP(p1, idx);
+        auto* gep2 = builder.CreateGEP(builder.CreateBitCast(cast, ptrType), idx);
+        auto* gep3 = builder.CreateGEP(p1, ConstantInt::get(intType, 1));
+        auto* checkedInEntry = builder.CreateLoad(gep1);
+        builder.CreateStore(ConstantInt::get(intType, 0), gep1);
+        auto* p3 = builder.CreateLoad(pp);
+        builder.CreateCondBr(builder.CreateICmpEQ(idx, ConstantInt::get(intType, 0)), then, exit);
+
+        builder.SetInsertPoint(then);
+        auto* checkedInThen = builder.CreateLoad(gep3);
+        builder.CreateBr(exit);
+
+        builder.SetInsertPoint(exit);
+        auto* checkedInExit = builder.CreateLoad(gep2);
+        auto* checkedAgain = builder.CreateLoad(gep3);
+        builder.CreateRetVoid();
+
+        ValueNumbering VN(*F);
+
+        // loads of the same pointer are equal until something may write to memory
+        EXPECT_EQ(VN.getNumber(p1), VN.getNumber(p2));
+        EXPECT_NE(VN.getNumber(p1), VN.getNumber(p3));
+
+        // casts share the number of their operand, GEPs are equal if their bases and indices are
+        EXPECT_EQ(VN.getNumber(p1), VN.getNumber(cast));
+        EXPECT_EQ(VN.getNumber(gep1), VN.getNumber(gep2));
+        EXPECT_NE(VN.getNumber(gep1), VN.getNumber(gep3));
+
+        // an equivalent check is reused only if it dominates the new one
+        EquivalentChecks checks(VN);
+        checks.record(gep1, checkedInEntry);
+        checks.record(gep3, checkedInThen);
+
+        auto&& reused = checks.findEquivalent(gep2, checkedInExit);
+        ASSERT_TRUE(!!reused);
+        EXPECT_EQ(reused.getUnsafe(), checkedInEntry);
+        EXPECT_FALSE(!!checks.findEquivalent(gep3, checkedAgain));
+        EXPECT_FALSE(!!checks.findEquivalent(gep3, checkedInThen));
+    }
+}
+
 } // namespace
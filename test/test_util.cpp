@@ -10,14 +10,27 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <unordered_set>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include <debugbreak/debugbreak.h>
 
 #include "Util/iterators.hpp"
 #include "Util/util.h"
 #include "Util/hash.hpp"
 #include "Util/hamt.hpp"
+#include "Executor/MemorySimulator/PagedMemoryImpl.h"
+#include "Interpreter/Domain/Memory/ArrayDomain.hpp"
+#include "Logging/async_appender.hpp"
+#include "Passes/Tracker/SourceLocationTracker/location_container.hpp"
+#include "Type/TypeFactory.h"
+#include "Util/locations.h"
+#include "Util/irf_ptr.hpp"
 
 
 namespace {
@@ -381,6 +394,108 @@ TEST(Util, indexed_string) {
     }
 }
 
+TEST(Util, indexed_string_generations) {
+    {
+        indexed_string kept = "Kept";
+        {
+            indexed_string dropped = "Dropped";
+            indexed_string copy = kept;
+            EXPECT_EQ(copy, kept);
+        }
+
+        indexed_string::nextGeneration();
+        EXPECT_EQ(kept.str(), "Kept");
+        EXPECT_EQ(kept, indexed_string("Kept"));
+
+        indexed_string again = "Dropped";
+        EXPECT_EQ(again.str(), "Dropped");
+        EXPECT_NE(again, kept);
+    }
+
+    {
+        // the shared cache holds whatever the rest of the process interned, so a separate one is used here
+        borealis::util::impl_::string_cache pool;
+
+        auto kept = pool["Kept"];
+        pool.acquire(kept);
+        auto dropped = pool["Dropped"];
+        pool.acquire(dropped);
+        pool.release(dropped);
+
+        EXPECT_EQ(pool.nextGeneration(), 1U);
+        EXPECT_EQ(pool[kept], "Kept");
+        EXPECT_EQ(pool["Kept"], kept);
+
+        auto reused = pool["Reused"];
+        EXPECT_EQ(reused, dropped);
+        EXPECT_EQ(pool[reused], "Reused");
+
+        // nothing is left unreferenced
+        pool.acquire(reused);
+        EXPECT_EQ(pool.nextGeneration(), 0U);
+        EXPECT_EQ(pool[reused], "Reused");
+    }
+}
+
+struct irf_tracked: irf_base<const irf_tracked> {
+    static size_t destroyed;
+    ~irf_tracked() { ++destroyed; }
+};
+size_t irf_tracked::destroyed = 0;
+
+struct irfd_tracked;
+
+struct irfd_counting_deleter {
+    size_t* released;
+    void operator()(const irfd_tracked* ptr);
+};
+
+struct irfd_tracked: irfd_base<const irfd_tracked, irfd_counting_deleter> {
+    irfd_tracked(irfd_counting_deleter d): irfd_base(d) {}
+};
+
+void irfd_counting_deleter::operator()(const irfd_tracked* ptr) {
+    ++*released;
+    delete ptr;
+}
+
+TEST(Util, irf_ptr_release) {
+    {
+        irf_tracked::destroyed = 0;
+        {
+            irf_ptr<const irf_tracked> first{ new irf_tracked{} };
+            {
+                auto second = first;
+                irf_ptr<const irf_tracked> third;
+                third = second;
+            }
+            EXPECT_EQ(irf_tracked::destroyed, 0U);
+        }
+        EXPECT_EQ(irf_tracked::destroyed, 1U);
+    }
+
+    {
+        using ptr_t = irfd_ptr<const irfd_tracked, irfd_counting_deleter>;
+
+        size_t released = 0;
+        {
+            ptr_t first{ new irfd_tracked(irfd_counting_deleter{ &released }) };
+            {
+                auto second = first;
+                ptr_t third;
+                third = second;
+            }
+            EXPECT_EQ(released, 0U);
+
+            // a copy is not referenced by the pointers to the original
+            ptr_t copy{ new irfd_tracked(*first) };
+            copy = nullptr;
+            EXPECT_EQ(released, 1U);
+        }
+        EXPECT_EQ(released, 2U);
+    }
+}
+
 struct hash_colliding {
     size_t value;
     hash_colliding(size_t value): value(value) {}
@@ -589,6 +704,292 @@ TEST(Util, hamt_complex) {
     }
 }
 
+TEST(Util, array_segments) {
+    using ArrayT = absint::AbstractFactory::ArrayT;
+
+    auto&& af = absint::AbstractFactory::get();
+    auto&& elemType = af->tf()->getInteger(32, llvm::Signedness::Signed);
+    auto&& ints = [&](std::vector<unsigned long long> values) {
+        return viewContainer(values).map(LAM(v, af->getInteger(v, 32))).toVector();
+    };
+    auto&& bounds = [](const ArrayT* array) {
+        return viewContainer(array->segments()).map(LAM(it, std::make_pair(it.first, it.second.end))).toVector();
+    };
+    using boundsT = std::vector<std::pair<size_t, size_t>>;
+
+    {
+        // equal adjacent values share one segment
+        auto&& array = ArrayT::constant(elemType, ints({ 1, 1, 2, 2, 2 }));
+        auto* raw = llvm::cast<ArrayT>(array.get());
+        EXPECT_EQ(bounds(raw), (boundsT{ { 0, 2 }, { 2, 5 } }));
+
+        // a store splits the segment and joins the stored value into the middle part
+        raw->store(af->getInteger(7, 32), af->getMachineInt(3));
+        EXPECT_EQ(bounds(raw), (boundsT{ { 0, 2 }, { 2, 3 }, { 3, 4 }, { 4, 5 } }));
+        EXPECT_TRUE(raw->segments().at(3).value->equals(af->getInteger(2, 32)->join(af->getInteger(7, 32))));
+        EXPECT_TRUE(raw->segments().at(4).value->equals(af->getInteger(2, 32)));
+
+        // storing the same value again changes nothing
+        raw->store(af->getInteger(2, 32), af->getMachineInt(4));
+        EXPECT_EQ(bounds(raw), (boundsT{ { 0, 2 }, { 2, 3 }, { 3, 4 }, { 4, 5 } }));
+    }
+
+    {
+        // trailing segments beyond the limit are smashed into the last one
+        auto&& limit = absint::arrayMaxSegments();
+        std::vector<unsigned long long> values;
+        for (auto i = 0U; i < limit + 10; ++i) values.push_back(i);
+
+        auto&& array = ArrayT::constant(elemType, ints(values));
+        auto* raw = llvm::cast<ArrayT>(array.get());
+        ASSERT_EQ(raw->segments().size(), limit);
+        EXPECT_TRUE(raw->segments().at(0).value->equals(af->getInteger(0, 32)));
+
+        auto&& last = raw->segments().rbegin();
+        EXPECT_EQ(last->first, limit - 1);
+        EXPECT_EQ(last->second.end, limit + 10);
+        EXPECT_TRUE(af->getInteger(limit - 1, 32)->leq(last->second.value));
+        EXPECT_TRUE(af->getInteger(limit + 9, 32)->leq(last->second.value));
+    }
+
+    {
+        // nested arrays are merged only if they are the same object
+        auto&& nestedType = af->tf()->getArray(elemType, 2);
+        auto&& nested = ArrayT::constant(elemType, ints({ 1, 2 }));
+        auto&& same = ArrayT::constant(af->tf()->getArray(nestedType, 2), { nested, nested });
+        EXPECT_EQ(llvm::cast<ArrayT>(same.get())->segments().size(), 1U);
+
+        auto&& copy = ArrayT::constant(elemType, ints({ 1, 2 }));
+        ASSERT_TRUE(nested->equals(copy));
+        auto&& distinct = ArrayT::constant(af->tf()->getArray(nestedType, 2), { nested, copy });
+        EXPECT_EQ(llvm::cast<ArrayT>(distinct.get())->segments().size(), 2U);
+    }
+}
+
+TEST(Util, paged_memory) {
+    using State = SegmentNode::MemoryState;
+    using Status = SegmentNode::MemoryStatus;
+
+    auto start = SimulatedPtr(0x10000);
+    PagedMemory mem{ start, start + 0x1000, 8, 64 };
+    ASSERT_EQ(mem.page_size, 64U);
+
+    auto&& page = [&](size_t index) { return mem.directory[0]->pages[index].get(); };
+
+    uint8_t data[32];
+    for (auto i = 0U; i < 32; ++i) data[i] = i;
+
+    // a buffer of [48, 80) crosses the border of the first two pages
+    auto buffer = start + 48;
+    mem.allocate(buffer, 32, State::Uninit, Status::Malloc);
+    EXPECT_EQ(mem.get(buffer + 8, 8).memState, State::Uninit);
+
+    mem.store(buffer, data, 24);
+    auto first = mem.get(buffer + 8, 8);
+    ASSERT_NE(first.data, nullptr);
+    EXPECT_EQ(first.data[0], 8);
+    EXPECT_EQ(first.data[7], 15);
+    auto second = mem.get(buffer + 16, 8);
+    ASSERT_NE(second.data, nullptr);
+    EXPECT_EQ(second.data[0], 16);
+    EXPECT_EQ(second.data[7], 23);
+
+    // partly initialized values are not loaded
+    mem.store(buffer + 24, data, 4);
+    auto partial = mem.get(buffer + 24, 8);
+    EXPECT_EQ(partial.data, nullptr);
+    EXPECT_EQ(partial.memState, State::Uninit);
+
+    EXPECT_THROW(mem.get(buffer + 32, 8), illegal_mem_read_exception);
+    EXPECT_THROW(mem.store(buffer + 28, data, 8), illegal_mem_write_exception);
+    EXPECT_THROW(mem.allocate(buffer + 8, 8, State::Uninit, Status::Malloc), std::logic_error);
+
+    mem.allocate(start, 8, State::Memset, Status::Alloca);
+    auto zeros = mem.get(start, 8);
+    ASSERT_NE(zeros.data, nullptr);
+    EXPECT_EQ(zeros.data[0], 0);
+
+    // a page is released with the last allocation in it
+    mem.free(buffer, Status::Malloc);
+    EXPECT_NE(page(0), nullptr);
+    EXPECT_EQ(page(1), nullptr);
+    EXPECT_THROW(mem.get(buffer + 16, 8), illegal_mem_read_exception);
+
+    EXPECT_THROW(mem.free(start, Status::Malloc), illegal_mem_free_exception);
+    mem.free(start, Status::Alloca);
+    EXPECT_EQ(page(0), nullptr);
+}
+
+TEST(Util, location_container) {
+    location_container<std::string> locs;
+    locs.put(Locus{ "f.c", 1, 1 }, "a");
+    locs.put(Locus{ "f.c", 3, 1 }, "d");
+    locs.put(Locus{ "f.c", 2, 1 }, "b");
+    locs.put(Locus{ "f.c", 2, 1 }, "c");
+
+    auto values = [](const location_container<std::string>::const_range& range) {
+        std::vector<std::string> res;
+        for (auto it = range.first; it != range.second; ++it) res.push_back(it->second);
+        return res;
+    };
+
+    // everything at the closest following location, in the order it was put
+    EXPECT_EQ((std::vector<std::string>{ "b", "c" }), values(locs.range_after(Locus{ "f.c", 1, 5 })));
+    EXPECT_EQ(std::vector<std::string>{ "d" }, values(locs.range_after(Locus{ "f.c", 2, 1 })));
+    EXPECT_TRUE(values(locs.range_after(Locus{ "f.c", 3, 1 })).empty());
+    EXPECT_TRUE(locs.contains(Locus{ "f.c", 2, 1 }));
+    EXPECT_FALSE(locs.contains(Locus{ "f.c", 2, 2 }));
+
+    // putting a value again moves it instead of adding a second entry
+    locs.put(Locus{ "f.c", 4, 1 }, "b");
+    EXPECT_EQ(std::vector<std::string>{ "c" }, values(locs.range_after(Locus{ "f.c", 1, 5 })));
+    EXPECT_EQ((Locus{ "f.c", 4, 1 }), locs["b"]);
+    EXPECT_EQ((Locus{ "f.c", 2, 1 }), locs["c"]);
+    EXPECT_EQ(4U, locs.getFrom().size());
+    EXPECT_EQ(4U, locs.getTo().size());
+
+    // the value index follows the entries after they are sorted
+    for (auto&& e : locs.getFrom()) {
+        EXPECT_EQ(e.first, locs[e.second]);
+    }
+}
+
+// collects what it is given, the async wrapper must never call it from two threads at once
+class CollectingAppender: public log4cpp::AppenderSkeleton {
+    std::atomic<bool> busy{ false };
+
+protected:
+    virtual void _append(const log4cpp::LoggingEvent& event) override {
+        EXPECT_FALSE(busy.exchange(true));
+        messages.push_back(event.message);
+        busy.store(false);
+    }
+
+public:
+    std::vector<std::string> messages;
+
+    explicit CollectingAppender(const std::string& name): log4cpp::AppenderSkeleton(name) {}
+
+    virtual void close() override {}
+    virtual bool requiresLayout() const override { return false; }
+    virtual void setLayout(log4cpp::Layout*) override {}
+};
+
+TEST(Util, async_appender) {
+    using logging::AsyncAppender;
+
+    auto event = [](const std::string& message) {
+        return log4cpp::LoggingEvent("test", message, "", log4cpp::Priority::INFO);
+    };
+
+    {
+        // several producers push way more than fits the queue
+        CollectingAppender target{ "collecting.many" };
+        AsyncAppender async{ &target, false, 16 };
+
+        const auto threads = 4U;
+        const auto perThread = 1000U;
+        std::vector<std::thread> producers;
+        for (auto t = 0U; t < threads; ++t) {
+            producers.emplace_back([&, t]() {
+                for (auto i = 0U; i < perThread; ++i) async.doAppend(event(util::toString(t * perThread + i)));
+            });
+        }
+        for (auto&& producer : producers) producer.join();
+        async.flush();
+
+        ASSERT_EQ(threads * perThread, target.messages.size());
+        std::unordered_set<std::string> unique(target.messages.begin(), target.messages.end());
+        EXPECT_EQ(threads * perThread, unique.size());
+
+        // the writer is running again after a flush
+        async.doAppend(event("after flush"));
+        async.close();
+        EXPECT_EQ("after flush", target.messages.back());
+    }
+
+    {
+        // after detach() in a forked child the events are written by the logging thread right away
+        CollectingAppender target{ "collecting.detached" };
+        AsyncAppender async{ &target, false, 16 };
+
+        auto child = ::fork();
+        ASSERT_NE(-1, child);
+        if (child == 0) {
+            async.detach();
+            async.doAppend(event("in child"));
+            auto written = target.messages.size() == 1 && target.messages.back() == "in child";
+            ::_exit(written ? 0 : 1);
+        }
+
+        int status;
+        ASSERT_EQ(child, ::waitpid(child, &status, 0));
+        ASSERT_TRUE(WIFEXITED(status));
+        EXPECT_EQ(0, WEXITSTATUS(status));
+        async.close();
+        EXPECT_TRUE(target.messages.empty());
+    }
+
+    {
+        // dump() stops the writer and writes the queued messages as they are
+        CollectingAppender target{ "collecting.dumped" };
+        AsyncAppender async{ &target, false, 16 };
+
+        int fds[2];
+        ASSERT_EQ(0, ::pipe(fds));
+        async.dump(fds[1]);
+        // the writer has left the queue alone by now
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        async.doAppend(event("first"));
+        async.doAppend(event("second"));
+        async.dump(fds[1]);
+        ::close(fds[1]);
+
+        std::string dumped;
+        char buffer[256];
+        for (ssize_t n; (n = ::read(fds[0], buffer, sizeof(buffer))) > 0;) dumped.append(buffer, n);
+        ::close(fds[0]);
+
+        EXPECT_EQ("test: first\ntest: second\n", dumped);
+        EXPECT_TRUE(target.messages.empty());
+    }
+}
+
+TEST(Util, interned_types) {
+    auto TF = TypeFactory::get();
+
+    // interned types are unique
+    auto i32 = TF->getInteger(32, llvm::Signedness::Signed);
+    EXPECT_EQ(i32, TF->getInteger(32, llvm::Signedness::Signed));
+    EXPECT_EQ(i32->getTypeId(), TF->getInteger(32, llvm::Signedness::Signed)->getTypeId());
+    EXPECT_NE(0U, i32->getTypeId());
+
+    // signedness changes the type, but not its shape
+    auto u32 = TF->getInteger(32, llvm::Signedness::Unsigned);
+    auto any32 = TF->getInteger(32, llvm::Signedness::Unknown);
+    EXPECT_NE(i32->getTypeId(), u32->getTypeId());
+    EXPECT_EQ(i32->getShapeId(), u32->getShapeId());
+    EXPECT_EQ(any32->getTypeId(), u32->getShapeId());
+
+    auto i64 = TF->getInteger(64, llvm::Signedness::Signed);
+    EXPECT_NE(i32->getShapeId(), i64->getShapeId());
+
+    // structural types are interned through their parts
+    auto ptr = TF->getPointer(i32);
+    EXPECT_EQ(ptr, TF->getPointer(TF->getInteger(32, llvm::Signedness::Signed)));
+    EXPECT_NE(ptr, TF->getPointer(u32));
+    EXPECT_NE(ptr, TF->getPointer(i32, 1));
+    EXPECT_EQ(TF->getArray(i32, 4), TF->getArray(i32, 4));
+    EXPECT_NE(TF->getArray(i32, 4)->getTypeId(), TF->getArray(i32, 8)->getTypeId());
+    EXPECT_EQ(TF->getFunction(i32, { ptr, i64 }), TF->getFunction(i32, { ptr, i64 }));
+
+    // records are looked up by name
+    auto record = TF->getRecord("test.interned");
+    EXPECT_EQ(record, TF->getRecord("test.interned"));
+    EXPECT_EQ(record->getTypeId(), TF->getRecord("test.interned")->getTypeId());
+    EXPECT_NE(record->getTypeId(), TF->getRecord("test.interned.other")->getTypeId());
+}
+
 #include "Util/unmacros.h"
 #include "Util/generate_unmacros.h"
 